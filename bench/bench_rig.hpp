@@ -0,0 +1,73 @@
+#pragma once
+// Piezas comunes de los microbenchmarks (bench/*.cpp): caché, bus y memoria
+// sueltos (sin Simulator) y los loops de asm del intérprete.
+
+#include "arena.hpp"
+#include "bus.hpp"
+#include "cache.hpp"
+#include "memory.hpp"
+#include "sim_config.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace sim::bench {
+
+// 'n' cachés (PE 0..n-1) sobre un bus sin directorio ni hilos: el bench
+// avanza el bus a mano con bus.step() / drain()
+struct Rig {
+  SimConfig                           cfg;
+  Arena                               arena;
+  Memory                              mem;
+  std::vector<Cache*>                 none;
+  Bus                                 bus;
+  std::vector<std::unique_ptr<Cache>> caches;
+
+  Rig(const SimConfig& c, std::size_t n)
+      : cfg(c), mem(cfg), bus(none, cfg) {
+    std::vector<Cache*> ptrs;
+    for (std::size_t i = 0; i < n; ++i) {
+      caches.push_back(std::make_unique<Cache>(static_cast<PEId>(i), bus, mem, cfg, arena));
+      ptrs.push_back(caches.back().get());
+    }
+    bus.set_caches(ptrs);
+  }
+
+  Cache& cache(std::size_t i = 0) { return *caches[i]; }
+  void   drain() { while (bus.pending()) bus.step(); }
+};
+
+// Loop de examples/demo.asm (LOAD/LOAD/FMUL/FADD/INC/INC/DEC/JNZ) sobre A/B de
+// 16 elementos: REG1/REG2 vuelven al inicio de A/B cada 16, así queda en caché
+inline const char* const kDotLoop = R"(
+outer:
+        MOVI    REG1, 0
+        MOVI    REG2, 256
+        MOVI    REG0, 16
+inner:
+        LOAD    REG5, [REG1]
+        LOAD    REG6, [REG2]
+        FMUL    REG7, REG5, REG6
+        FADD    REG4, REG4, REG7
+        INC     REG1
+        INC     REG2
+        DEC     REG0
+        JNZ     inner
+        MOVI    REG0, 1
+        JNZ     outer
+)";
+
+// Loop sin memoria (MOVI/FMUL/FADD/DEC/JNZ): sólo dispatch. REG0 = iteraciones
+inline const char* const kAluLoop = R"(
+        MOVI    REG5, 4607182418800017408
+        MOVI    REG6, 4611686018427387904
+loop:
+        FMUL    REG7, REG5, REG6
+        FADD    REG4, REG4, REG7
+        INC     REG1
+        DEC     REG0
+        JNZ     loop
+)";
+
+} // namespace sim::bench
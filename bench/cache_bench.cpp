@@ -0,0 +1,178 @@
+// Microbenchmark de la caché: costo de la búsqueda de tag (find_way) vía la
+// API pública, para varias asociatividades.
+//
+//   make bench-cache                 (compila sin logs, objetos en build/bench)
+//   build/bench/cache_bench [lines] [iters]
+//
+// - load hit:   working set = capacidad de la caché, todo residente
+// - snoop miss: Cache::snoop de líneas ausentes (sólo index_tag + find_way)
+// - load miss:  recorrido de 4x la capacidad (víctima + fill + push al bus)
+//
+// La segunda tabla repite snoop miss y load hit con cada --tag-match que
+// soporte el CPU (escalar vs SSE4.1 vs AVX2).
+//
+// La tercera da el hit rate de cada --repl (16 ways) en tres patrones:
+// loop cíclico de 1.5x la capacidad, set caliente + scan (resistencia a
+// scans) y accesos al azar sobre 2x la capacidad.
+
+#include "bench_rig.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace sim;
+using sim::bench::Rig;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template <class F>
+double ns_per_op(std::size_t ops, F&& f) {
+  const auto t0 = Clock::now();
+  f();
+  const auto t1 = Clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(ops);
+}
+
+struct Row {
+  double hit, snoop, miss;
+};
+
+Row run(std::size_t ways, std::size_t lines, std::size_t iters, TagMatch tm = TagMatch::Auto) {
+  SimConfig cfg;
+  cfg.num_pes     = 1;
+  cfg.cache_ways  = ways;
+  cfg.cache_lines = lines;
+  cfg.line_bytes  = 64;
+  cfg.mem_words   = lines * 8 * 8;       // 8x la capacidad de la caché
+  cfg.tag_match   = tm;
+  cfg.validate();
+
+  Rig rig(cfg, 1);
+  Cache& cache = rig.cache();
+  auto drain = [&] { rig.drain(); };
+
+  const std::size_t cap = lines * cfg.line_bytes;
+  std::mt19937_64 rng(42);
+  Word sink = 0, w = 0;
+
+  // Calentamiento: toda la capacidad residente (cada set queda lleno)
+  for (Addr a = 0; a < cap; a += cfg.line_bytes) cache.load(a, sizeof(Word), w);
+  drain();
+
+  std::vector<Addr> hit_addrs(4096), miss_addrs(4096);
+  for (auto& a : hit_addrs)  a = (rng() % (cap / sizeof(Word))) * sizeof(Word);
+  for (auto& a : miss_addrs) a = cap + (rng() % (cap / cfg.line_bytes)) * cfg.line_bytes;
+
+  Row r{};
+  r.hit = ns_per_op(iters, [&] {
+    for (std::size_t i = 0; i < iters; ++i) {
+      cache.load(hit_addrs[i & 4095], sizeof(Word), w);
+      sink += w;
+    }
+  });
+
+  std::optional<Word> out;
+  r.snoop = ns_per_op(iters, [&] {
+    for (std::size_t i = 0; i < iters; ++i) {
+      BusRequest req{BusCmd::BusRd, 1, miss_addrs[i & 4095], cfg.line_bytes};
+      sink += cache.snoop(req, out);
+    }
+  });
+
+  const std::size_t miss_iters = iters / 8;
+  r.miss = ns_per_op(miss_iters, [&] {
+    for (std::size_t i = 0; i < miss_iters; ++i) {
+      cache.load((i * cfg.line_bytes) % (4 * cap), sizeof(Word), w);
+      sink += w;
+      if ((i & 255) == 255) drain();
+    }
+    drain();
+  });
+
+  if (sink == 0x5eed) std::puts("");  // que el compilador no descarte nada
+  return r;
+}
+
+// Hit rate (%) de 'policy' en un patrón de direcciones de línea
+template <class NextLine>
+double hit_rate(ReplPolicy policy, std::size_t lines, std::size_t accesses, NextLine&& next) {
+  SimConfig cfg;
+  cfg.num_pes     = 1;
+  cfg.cache_ways  = 16;
+  cfg.cache_lines = lines;
+  cfg.line_bytes  = 64;
+  cfg.mem_words   = lines * 8 * 8;
+  cfg.repl        = policy;
+  cfg.validate();
+
+  Rig rig(cfg, 1);
+  Cache& cache = rig.cache();
+  Word w = 0;
+  for (std::size_t i = 0; i < accesses; ++i) {
+    cache.load(next(i) * cfg.line_bytes, sizeof(Word), w);
+    if ((i & 255) == 255) rig.drain();
+  }
+  const auto& m = cache.metrics();
+  return 100.0 * static_cast<double>(m.hits) / static_cast<double>(m.loads);
+}
+
+void repl_table(std::size_t lines) {
+  const std::size_t acc = 400'000;
+  std::printf("\nhit %% por --repl (16 ways, %zu líneas)\n%8s %10s %10s %10s\n",
+              lines, "repl", "loop1.5x", "hot+scan", "rand2x");
+  for (ReplPolicy p : {ReplPolicy::LRU, ReplPolicy::PLRU, ReplPolicy::FIFO, ReplPolicy::Random,
+                       ReplPolicy::SRRIP, ReplPolicy::BRRIP, ReplPolicy::DRRIP}) {
+    const double loop = hit_rate(p, lines, acc, [&](std::size_t i) { return i % (lines + lines / 2); });
+    // 3 de cada 4 accesos a un set caliente de lines/2; el resto, un scan que no se repite
+    const double scan = hit_rate(p, lines, acc, [&](std::size_t i) {
+      return (i & 3) ? (i * 7) % (lines / 2) : lines + (i >> 2) % (6 * lines);
+    });
+    std::mt19937_64 rng(7);
+    const double rnd = hit_rate(p, lines, acc, [&](std::size_t) { return rng() % (2 * lines); });
+    std::printf("%8s %10.2f %10.2f %10.2f\n", to_string(p), loop, scan, rnd);
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t lines = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512;
+  const std::size_t iters = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4'000'000;
+
+  constexpr std::size_t kWays[] = {1, 2, 4, 8, 16, 32};
+
+  std::printf("cache_bench: lines=%zu line_bytes=64 iters=%zu tag-match=%s\n",
+              lines, iters, tagmatch::name(tagmatch::resolve(TagMatch::Auto)));
+  std::printf("%6s %14s %14s %14s\n", "ways", "load_hit ns", "snoop_miss ns", "load_miss ns");
+  for (std::size_t ways : kWays) {
+    if (lines % ways) continue;
+    const Row r = run(ways, lines, iters);
+    std::printf("%6zu %14.2f %14.2f %14.2f\n", ways, r.hit, r.snoop, r.miss);
+  }
+
+  std::vector<TagMatch> variants;
+  for (TagMatch m : {TagMatch::Scalar, TagMatch::Sse41, TagMatch::Avx2})
+    if (tagmatch::supported(m)) variants.push_back(m);
+
+  std::printf("\nsnoop_miss / load_hit ns por tag-match\n%6s", "ways");
+  for (TagMatch m : variants) std::printf(" %18s", tagmatch::name(m));
+  std::printf("\n");
+  for (std::size_t ways : kWays) {
+    if (lines % ways) continue;
+    std::printf("%6zu", ways);
+    for (TagMatch m : variants) {
+      const Row r = run(ways, lines, iters / 2, m);
+      std::printf(" %8.2f / %7.2f", r.snoop, r.hit);
+    }
+    std::printf("\n");
+  }
+
+  repl_table(lines);
+  return 0;
+}
@@ -0,0 +1,65 @@
+// Microbenchmark del intérprete: instrucciones simuladas por segundo de un
+// solo PE (Processor::step) con la caché caliente, sin hilos ni ticks.
+//
+//   make bench-interp                (compila sin logs, objetos en build/bench)
+//   build/bench/interp_bench [iters]
+//
+// - dot:  el loop de examples/demo.asm (LOAD/LOAD/FMUL/FADD/INC/INC/DEC/JNZ)
+//         sobre A/B de 16 elementos que quedan en caché
+// - alu:  loop sin memoria (MOVI/FMUL/FADD/DEC/JNZ): sólo dispatch
+//
+// Cada loop se mide con y sin superinstrucciones (Processor::set_fusion).
+// El bus se avanza cada 64 pasos (sólo tiene los fills del arranque).
+
+#include "bench_rig.hpp"
+#include "processor.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace sim;
+using sim::bench::Rig;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// M instrucciones/s ejecutando 'iters' pasos (el programa dot no termina solo)
+double minstr_per_s(const char* src, std::size_t iters, bool fuse) {
+  SimConfig cfg;
+  cfg.num_pes   = 1;
+  cfg.mem_words = 4096;
+  cfg.validate();
+
+  Rig rig(cfg, 1);
+  Processor pe(0, rig.cache());
+  pe.set_fusion(fuse);
+  pe.load_program_from_string(src);
+  pe.set_reg(0, iters);  // alu: contador del loop
+
+  std::size_t n = 0;
+  const auto t0 = Clock::now();
+  for (; n < iters && !pe.is_done(); ++n) {
+    pe.step();
+    if ((n & 63) == 0) rig.bus.step();
+  }
+  const auto t1 = Clock::now();
+  return static_cast<double>(n) / std::chrono::duration<double, std::micro>(t1 - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t iters = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20'000'000;
+
+  std::printf("interp_bench: iters=%zu (M instr/s)\n%6s %12s %12s\n", iters, "loop", "fuse off", "fuse on");
+  std::printf("%6s %12.2f %12.2f\n", "dot",
+              minstr_per_s(bench::kDotLoop, iters, false), minstr_per_s(bench::kDotLoop, iters, true));
+  std::printf("%6s %12.2f %12.2f\n", "alu",
+              minstr_per_s(bench::kAluLoop, iters, false), minstr_per_s(bench::kAluLoop, iters, true));
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Microbenchmark del logger: ns por evento de un log típico del hot path
+// ("[CACHE PE..] LOAD addr=.. set=.. tag=.. (hit)") con stderr descartado.
+//
+//   make bench-log                   (objetos en build/bench)
+//   build/bench/log_bench [eventos]
+//
+// - iostream: lo que hacía LOG_IF (osyncstream(cerr) << ... por evento)
+// - LOGF:     costo en el hilo que loguea (copia binaria al ring), en ráfagas
+//             cortas drenadas con flush() entre una y otra
+// - LOGF+fmt: más el formateo de esas ráfagas (lo que paga el drenador)
+//
+// El build de bench compila con MPMESI_LOG=0, así que se llama a
+// log::emit directo (es lo que LOGF expande con el nivel encendido).
+
+#include "config.hpp"
+#include "log.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+
+using namespace sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Descarta todo (que el costo medido sea formatear, no escribir a la terminal)
+struct NullBuf : std::streambuf {
+  int             overflow(int c) override { return c; }
+  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+double ns_per(Clock::time_point t0, Clock::time_point t1, std::size_t n) {
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(n);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+
+  NullBuf null;
+  std::streambuf* old = std::cerr.rdbuf(&null);
+
+  const auto a0 = Clock::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    const std::uint64_t addr = i * 8;
+    SERR << "[CACHE PE" << (i & 3) << "] LOAD addr=0x" << std::hex << addr << std::dec
+         << " set=" << (i & 7) << " tag=" << (addr >> 8) << ((i & 1) ? " (hit)" : " (miss)") << '\n';
+  }
+  const auto a1 = Clock::now();
+
+  // Calienta el ring del hilo (registro + arranque del drenador)
+  log::emit("warmup");
+  log::flush();
+
+  // Ráfagas de 1/4 de ring: el hilo nunca espera ni despierta al drenador
+  // (eso pasa a medio ring), así se mide sólo el costo en el hot path
+  constexpr std::size_t kBurst = log::Ring::kCap / 4;
+  Clock::duration burst{}, drain{};
+  for (std::size_t done = 0; done < n; done += kBurst) {
+    const auto t0 = Clock::now();
+    for (std::size_t i = done; i < done + kBurst; ++i) {
+      const std::uint64_t addr = i * 8;
+      log::emit("[CACHE PE{}] LOAD addr=0x{x} set={} tag={}{}",
+                i & 3, addr, i & 7, addr >> 8, (i & 1) ? " (hit)" : " (miss)");
+    }
+    const auto t1 = Clock::now();
+    log::flush();
+    burst += t1 - t0;
+    drain += Clock::now() - t1;
+  }
+  const std::size_t m = (n + kBurst - 1) / kBurst * kBurst;
+  std::cerr.rdbuf(old);
+  std::printf("log_bench: eventos=%zu (ns/evento)\n", n);
+  std::printf("%10s %10.1f\n", "iostream", ns_per(a0, a1, n));
+  std::printf("%10s %10.1f\n", "LOGF", ns_per({}, Clock::time_point{burst}, m));
+  std::printf("%10s %10.1f\n", "LOGF+fmt", ns_per({}, Clock::time_point{burst + drain}, m));
+  return 0;
+}
@@ -0,0 +1,94 @@
+// Microbenchmark de Memory: fills/flushes de línea desde varios hilos, como
+// los hacen los PEs en la fase PE y los bancos del bus.
+//
+//   make bench-mem                   (compila sin logs, objetos en build/bench)
+//   build/bench/memory_bench [iters]
+//
+// - word: la línea palabra a palabra con read64/write64 (el camino de antes,
+//         un lock por palabra)
+// - line: read_line/write_line (un memcpy bajo el lock de la stripe)
+//
+// Cada hilo recorre su propia región (privada) o todos la misma (compartida:
+// chocan en las mismas stripes). Se reporta M líneas/s (fill + flush = 1).
+
+#include "memory.hpp"
+#include "sim_config.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace sim;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kLineBytes   = 64;
+constexpr std::size_t kRegionLines = 1024;   // 64 KB por hilo
+
+double mlines_per_s(Memory& mem, std::size_t threads, std::size_t iters, bool bulk, bool shared) {
+  auto body = [&](std::size_t t) {
+    alignas(64) std::uint8_t buf[kLineBytes];
+    const Addr region = shared ? 0 : t * kRegionLines * kLineBytes;
+    for (std::size_t i = 0; i < iters; ++i) {
+      // Paso impar para no ir en orden (stripes distintas entre hilos vecinos)
+      const Addr base = region + ((i * 7 + t) % kRegionLines) * kLineBytes;
+      if (bulk) {
+        mem.read_line(base, buf);
+        buf[0]++;
+        mem.write_line(base, buf);
+      } else {
+        for (std::size_t off = 0; off < kLineBytes; off += sizeof(Word)) {
+          Word w = mem.read64(base + off);
+          std::copy_n(reinterpret_cast<const std::uint8_t*>(&w), sizeof(Word), buf + off);
+        }
+        buf[0]++;
+        for (std::size_t off = 0; off < kLineBytes; off += sizeof(Word)) {
+          Word w;
+          std::copy_n(buf + off, sizeof(Word), reinterpret_cast<std::uint8_t*>(&w));
+          mem.write64(base + off, w);
+        }
+      }
+    }
+  };
+
+  const auto t0 = Clock::now();
+  std::vector<std::thread> pool;
+  for (std::size_t t = 0; t < threads; ++t) pool.emplace_back(body, t);
+  for (auto& th : pool) th.join();
+  const double s = std::chrono::duration<double>(Clock::now() - t0).count();
+  return static_cast<double>(threads * iters) / s / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t iters = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 400000;
+  const std::size_t hw    = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<std::size_t> counts{1, 2, 4, 8};
+  if (hw > 8) counts.push_back(hw);
+
+  SimConfig cfg;
+  cfg.line_bytes = kLineBytes;
+  cfg.mem_words  = counts.back() * kRegionLines * kLineBytes / sizeof(Word);
+  cfg.validate();
+  Memory mem(cfg);
+
+  std::printf("memory_bench: line_bytes=%zu iters/hilo=%zu (M líneas/s, fill+flush)\n",
+              kLineBytes, iters);
+  std::printf("%7s %12s %12s %12s %12s\n", "hilos", "priv word", "priv line", "comp word", "comp line");
+  for (std::size_t t : counts) {
+    std::printf("%7zu %12.2f %12.2f %12.2f %12.2f\n", t,
+                mlines_per_s(mem, t, iters, false, false),
+                mlines_per_s(mem, t, iters, true,  false),
+                mlines_per_s(mem, t, iters, false, true),
+                mlines_per_s(mem, t, iters, true,  true));
+  }
+  return 0;
+}
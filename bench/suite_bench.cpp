@@ -0,0 +1,377 @@
+// Suite de benchmarks con baseline: microbenchmarks de las piezas calientes y
+// kernels de punta a punta, todo como throughput (más es mejor).
+//
+//   make bench                       (compara contra bench/baseline.json)
+//   make bench-baseline              (reescribe el baseline con esta máquina)
+//   build/bench/suite_bench [--json OUT] [--baseline FILE] [--threshold PCT]
+//                           [--reps N] [--only SUBCADENA]
+//
+// Micro (M ops/s):
+// - cache_load_hit / cache_store_hit: Cache::load/store sobre líneas residentes
+//   (8 ways, 512 líneas; store en write-back, la línea ya en M)
+// - bus_broadcast_rd / bus_broadcast_rdx: miss de load/store + Bus::step, con
+//   la request difundida a 8 cachés
+// - mem_read64: Memory::read64 al azar sobre 512 KiB
+// - interp_dot / interp_alu: Processor::step (con superinstrucciones), con los
+//   loops de bench_rig.hpp (los mismos que interp_bench)
+// Punta a punta (ticks/s, engine inline, salida descartada):
+// - e2e_dot_*: examples/demo.asm con dot-n 32768 en varias configuraciones
+// - e2e_vec_4pe: examples/demo_vec.asm
+//
+// Cada caso corre --reps veces (def. 3) y se queda con la mejor. Con
+// --baseline, un caso que cae más de --threshold % (def. 10) contra el
+// baseline se vuelve a medir (otras --reps) y, si sigue abajo, se marca
+// REGRESIÓN y el programa sale con 1. El baseline guarda el host (modelo de
+// CPU y --tag-match): si no coincide con el actual se muestran los deltas pero
+// no se marcan regresiones (no son comparables).
+
+#include "bench_rig.hpp"
+#include "processor.hpp"
+#include "simulator.hpp"
+#include "tag_match.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace sim;
+using sim::bench::Rig;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  std::string name;
+  std::string unit;
+  double      value = 0;
+};
+
+// Un caso devuelve (operaciones, segundos) de una corrida
+struct Case {
+  const char* name;
+  const char* unit;
+  double      scale;  // ops/s -> unidad (1e-6 para M ops/s)
+  std::function<std::pair<double, double>()> run;
+};
+
+double secs_since(Clock::time_point t0) {
+  return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Descarta la salida del simulador en los kernels de punta a punta
+struct NullBuf : std::streambuf {
+  int             overflow(int c) override { return c; }
+  std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+SimConfig micro_cfg(std::size_t pes, WritePolicy wp = WritePolicy::WriteThrough) {
+  SimConfig cfg;
+  cfg.num_pes      = pes;
+  cfg.cache_ways   = 8;
+  cfg.cache_lines  = 512;
+  cfg.line_bytes   = 64;
+  cfg.mem_words    = 512 * 8 * 16;  // 16x la capacidad de una caché
+  cfg.write_policy = wp;
+  cfg.validate();
+  return cfg;
+}
+
+Word g_sink = 0;  // que el compilador no descarte los loops
+
+std::pair<double, double> cache_hit(bool store) {
+  Rig r(micro_cfg(1, store ? WritePolicy::WriteBack : WritePolicy::WriteThrough), 1);
+  Cache& c = r.cache();
+  const std::size_t cap = r.cfg.cache_lines * r.cfg.line_bytes;
+  Word w = 0;
+  // Toda la capacidad residente (en M para el caso store)
+  for (Addr a = 0; a < cap; a += r.cfg.line_bytes) {
+    while (!(store ? c.store(a, sizeof(Word), a) : c.load(a, sizeof(Word), w))) r.drain();
+  }
+  std::mt19937_64 rng(42);
+  std::vector<Addr> addrs(4096);
+  for (auto& a : addrs) a = (rng() % (cap / sizeof(Word))) * sizeof(Word);
+
+  const std::size_t n = 8'000'000;
+  const auto t0 = Clock::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    if (store) c.store(addrs[i & 4095], sizeof(Word), i);
+    else     { c.load(addrs[i & 4095], sizeof(Word), w); g_sink += w; }
+  }
+  return {static_cast<double>(n), secs_since(t0)};
+}
+
+// Cada acceso es un miss de una caché distinta (round robin) y el bus lo
+// difunde a las 8 en el mismo paso
+std::pair<double, double> bus_broadcast(bool rdx) {
+  constexpr std::size_t kCaches = 8;
+  Rig r(micro_cfg(kCaches), kCaches);
+  const std::size_t span = r.cfg.mem_words * sizeof(Word);
+  const std::size_t n    = 400'000;
+  Word w = 0;
+  const auto t0 = Clock::now();
+  for (std::size_t i = 0; i < n; ++i) {
+    const Addr a = (i * r.cfg.line_bytes * 3) % span;  // siempre fuera de la caché
+    Cache& c = r.cache(i % kCaches);
+    if (rdx) c.store(a, sizeof(Word), i);
+    else     c.load(a, sizeof(Word), w);
+    r.bus.step();
+  }
+  r.drain();
+  g_sink += w;
+  return {static_cast<double>(n), secs_since(t0)};
+}
+
+std::pair<double, double> mem_read64() {
+  SimConfig cfg = micro_cfg(1);
+  cfg.mem_words = 64 * 1024;
+  Memory mem(cfg);
+  for (Addr a = 0; a < cfg.mem_words * sizeof(Word); a += sizeof(Word)) mem.write64(a, a);
+  std::mt19937_64 rng(7);
+  std::vector<Addr> addrs(4096);
+  for (auto& a : addrs) a = (rng() % cfg.mem_words) * sizeof(Word);
+
+  const std::size_t n = 20'000'000;
+  Word acc = 0;
+  const auto t0 = Clock::now();
+  for (std::size_t i = 0; i < n; ++i) acc += mem.read64(addrs[i & 4095]);
+  g_sink += acc;
+  return {static_cast<double>(n), secs_since(t0)};
+}
+
+std::pair<double, double> interp(const char* src) {
+  SimConfig cfg = micro_cfg(1);
+  cfg.mem_words = 4096;
+  Rig r(cfg, 1);
+  Processor pe(0, r.cache());
+  pe.load_program_from_string(src);
+  const std::size_t n = 10'000'000;
+  pe.set_reg(0, n);  // alu: contador del loop
+
+  std::size_t i = 0;
+  const auto t0 = Clock::now();
+  for (; i < n && !pe.is_done(); ++i) {
+    pe.step();
+    if ((i & 63) == 0) r.bus.step();
+  }
+  return {static_cast<double>(i), secs_since(t0)};
+}
+
+// Como main.cpp con un .asm: Simulator::dot_layout y run_until_done
+std::pair<double, double> e2e(const char* asm_path, std::size_t pes, WritePolicy wp, BusModel bm) {
+  SimConfig cfg;
+  cfg.engine       = Engine::Inline;
+  cfg.num_pes      = pes;
+  cfg.dot_n        = 32768;
+  cfg.mem_words    = 70'000;
+  cfg.dump_mem     = false;
+  cfg.write_policy = wp;
+  cfg.bus_model    = bm;
+  cfg.validate();
+
+  const auto L = Simulator::dot_layout(cfg);
+
+  NullBuf null;
+  std::streambuf* out = std::cout.rdbuf(&null);
+  std::streambuf* err = std::cerr.rdbuf(&null);
+  double secs = 0;
+  std::size_t ticks = 0;
+  {
+    Simulator s(cfg);
+    s.init_dot_problem(cfg.dot_n, L.baseA, L.baseB, L.basePS);
+    s.load_program_all_from_file(asm_path);
+    const auto t0 = Clock::now();
+    s.run_until_done();
+    secs  = secs_since(t0);
+    ticks = s.ticks_run();
+  }
+  std::cout.rdbuf(out);
+  std::cerr.rdbuf(err);
+  return {static_cast<double>(ticks), secs};
+}
+
+// Host de la medición: modelo de CPU (/proc/cpuinfo) y tag-match resuelto
+struct Host {
+  std::string cpu;
+  std::string tag_match;
+  bool operator==(const Host&) const = default;
+};
+
+Host this_host() {
+  Host h{"desconocido", tagmatch::name(tagmatch::resolve(TagMatch::Auto))};
+  std::ifstream in("/proc/cpuinfo");
+  for (std::string line; std::getline(in, line); ) {
+    if (line.rfind("model name", 0) != 0) continue;
+    const std::size_t c = line.find(':');
+    if (c == std::string::npos) break;
+    h.cpu = line.substr(line.find_first_not_of(' ', c + 1));
+    // Sin comillas ni barras: va tal cual a un string JSON
+    h.cpu.erase(std::remove_if(h.cpu.begin(), h.cpu.end(), [](char ch) { return ch == '"' || ch == '\\'; }),
+                h.cpu.end());
+    break;
+  }
+  return h;
+}
+
+struct Baseline {
+  Host                host;
+  std::vector<Result> results;
+};
+
+// Valor string de "key" (o vacío si no está)
+std::string json_string(const std::string& s, const char* key) {
+  const std::size_t k = s.find(std::string("\"") + key + "\"");
+  if (k == std::string::npos) return {};
+  const std::size_t q0 = s.find('"', s.find(':', k) + 1);
+  const std::size_t q1 = q0 == std::string::npos ? q0 : s.find('"', q0 + 1);
+  if (q1 == std::string::npos) return {};
+  return s.substr(q0 + 1, q1 - q0 - 1);
+}
+
+// Baseline: {"cpu": "...", "tag_match": "...", "results": [{"name": "...", "unit": "...", "value": N}, ...]}
+// Lectura mínima: sólo busca las claves que escribe write_json
+Baseline read_json(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) return {};
+  std::stringstream ss;
+  ss << in.rdbuf();
+  const std::string s = ss.str();
+
+  Baseline out;
+  out.host = {json_string(s, "cpu"), json_string(s, "tag_match")};
+  for (std::size_t p = s.find("\"name\""); p != std::string::npos; p = s.find("\"name\"", p + 1)) {
+    const std::size_t q0 = s.find('"', s.find(':', p) + 1);
+    const std::size_t q1 = s.find('"', q0 + 1);
+    const std::size_t v  = s.find("\"value\"", q1);
+    if (q0 == std::string::npos || q1 == std::string::npos || v == std::string::npos) break;
+    Result r;
+    r.name  = s.substr(q0 + 1, q1 - q0 - 1);
+    r.value = std::strtod(s.c_str() + s.find(':', v) + 1, nullptr);
+    out.results.push_back(r);
+  }
+  return out;
+}
+
+void write_json(const std::string& path, const Host& host, const std::vector<Result>& rs) {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    std::fprintf(stderr, "suite_bench: no se puede escribir %s\n", path.c_str());
+    std::exit(2);
+  }
+  out << "{\n  \"cpu\": \"" << host.cpu << "\",\n"
+      << "  \"tag_match\": \"" << host.tag_match << "\",\n"
+      << "  \"results\": [\n";
+  char num[64];
+  for (std::size_t i = 0; i < rs.size(); ++i) {
+    std::snprintf(num, sizeof num, "%.3f", rs[i].value);
+    out << "    {\"name\": \"" << rs[i].name << "\", \"unit\": \"" << rs[i].unit
+        << "\", \"value\": " << num << "}" << (i + 1 < rs.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::string json_out, baseline, only;
+  double      threshold = 10.0;
+  std::size_t reps      = 3;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    auto next = [&]() -> std::string {
+      if (i + 1 >= argc) { std::fprintf(stderr, "suite_bench: falta el valor de %s\n", a.c_str()); std::exit(2); }
+      return argv[++i];
+    };
+    if      (a == "--json")      json_out  = next();
+    else if (a == "--baseline")  baseline  = next();
+    else if (a == "--threshold") threshold = std::strtod(next().c_str(), nullptr);
+    else if (a == "--reps")      reps      = std::max<std::size_t>(1, std::strtoull(next().c_str(), nullptr, 10));
+    else if (a == "--only")      only      = next();
+    else { std::fprintf(stderr, "suite_bench: opción desconocida %s\n", a.c_str()); return 2; }
+  }
+
+  const Case cases[] = {
+    {"cache_load_hit",    "Mops/s",  1e-6, [] { return cache_hit(false); }},
+    {"cache_store_hit",   "Mops/s",  1e-6, [] { return cache_hit(true); }},
+    {"bus_broadcast_rd",  "Mops/s",  1e-6, [] { return bus_broadcast(false); }},
+    {"bus_broadcast_rdx", "Mops/s",  1e-6, [] { return bus_broadcast(true); }},
+    {"mem_read64",        "Mops/s",  1e-6, [] { return mem_read64(); }},
+    {"interp_dot",        "Minstr/s", 1e-6, [] { return interp(bench::kDotLoop); }},
+    {"interp_alu",        "Minstr/s", 1e-6, [] { return interp(bench::kAluLoop); }},
+    {"e2e_dot_4pe",       "ticks/s", 1.0, [] {
+       return e2e("examples/demo.asm", 4, WritePolicy::WriteThrough, BusModel::Atomic); }},
+    {"e2e_dot_16pe_wb",   "ticks/s", 1.0, [] {
+       return e2e("examples/demo.asm", 16, WritePolicy::WriteBack, BusModel::Atomic); }},
+    {"e2e_dot_4pe_split", "ticks/s", 1.0, [] {
+       return e2e("examples/demo.asm", 4, WritePolicy::WriteThrough, BusModel::Split); }},
+    {"e2e_vec_4pe",       "ticks/s", 1.0, [] {
+       return e2e("examples/demo_vec.asm", 4, WritePolicy::WriteThrough, BusModel::Atomic); }},
+  };
+
+  const Host     host = this_host();
+  const Baseline bl   = baseline.empty() ? Baseline{} : read_json(baseline);
+  const auto&    base = bl.results;
+  if (!baseline.empty() && base.empty())
+    std::printf("suite_bench: sin baseline en %s (make bench-baseline para crearlo)\n", baseline.c_str());
+  // Un baseline de otra máquina sólo sirve de referencia: no marca regresiones
+  const bool same_host = bl.host == host;
+  if (!base.empty() && !same_host)
+    std::printf("suite_bench: el baseline es de otro host (cpu=\"%s\" tag-match=%s; este: cpu=\"%s\" "
+                "tag-match=%s): no se marcan regresiones\n",
+                bl.host.cpu.c_str(), bl.host.tag_match.c_str(), host.cpu.c_str(), host.tag_match.c_str());
+
+  std::printf("suite_bench: reps=%zu threshold=%.1f%%\n%-20s %14s %-9s %14s %9s\n",
+              reps, threshold, "caso", "valor", "unidad", "baseline", "delta");
+  std::vector<Result> results;
+  std::size_t regressions = 0;
+  for (const auto& c : cases) {
+    if (!only.empty() && std::strstr(c.name, only.c_str()) == nullptr) continue;
+    double best = 0;
+    auto measure = [&] {
+      for (std::size_t r = 0; r < reps; ++r) {
+        const auto [ops, secs] = c.run();
+        if (secs > 0) best = std::max(best, ops / secs * c.scale);
+      }
+    };
+    measure();
+
+    const auto it = std::find_if(base.begin(), base.end(), [&](const Result& b) { return b.name == c.name; });
+    if (it == base.end() || it->value <= 0) {
+      results.push_back({c.name, c.unit, best});
+      std::printf("%-20s %14.2f %-9s %14s %9s\n", c.name, best, c.unit, "-", "-");
+      continue;
+    }
+    // Una caída puede ser ruido del host (otro proceso en el mismo núcleo):
+    // antes de marcarla se vuelve a medir y cuenta la mejor de todas
+    if (same_host && best < it->value * (1.0 - threshold / 100.0)) measure();
+    results.push_back({c.name, c.unit, best});
+    const double delta = 100.0 * (best - it->value) / it->value;
+    const bool   bad   = same_host && delta < -threshold;
+    regressions += bad;
+    std::printf("%-20s %14.2f %-9s %14.2f %+8.1f%%%s\n", c.name, best, c.unit, it->value, delta,
+                bad ? "  REGRESIÓN" : "");
+  }
+
+  if (!json_out.empty()) {
+    write_json(json_out, host, results);
+    std::printf("suite_bench: resultados en %s\n", json_out.c_str());
+  }
+  if (regressions) {
+    std::printf("suite_bench: %zu caso(s) más de %.1f%% por debajo del baseline\n", regressions, threshold);
+    return 1;
+  }
+  if (g_sink == 0x5eed) std::puts("");
+  return 0;
+}
@@ -0,0 +1,29 @@
+; ============================================================================
+; demo_vec.asm - Mismo producto punto que demo.asm con instrucciones vectoriales
+; Cada VLOAD trae una línea completa (VL = line-bytes/8 doubles) en un acceso;
+; la cola (REG0 < VL) la enmascara el propio VLOAD.
+; ============================================================================
+
+        ; REG0 = contador de elementos (lo setea el simulador)
+        ; REG1 = puntero a A
+        ; REG2 = puntero a B
+        ; REG3 = &partial_sums[PE]
+        ; REG4 = suma parcial (double bits)
+        ; V0   = acumulador por lane
+        ; V1   = bloque de A
+        ; V2   = bloque de B
+
+        VZERO   V0               ; Acumuladores = 0.0
+
+start:
+        VLOAD   V1, [REG1]       ; A[i .. i+VL)
+        VLOAD   V2, [REG2]       ; B[i .. i+VL)
+        VFMA    V0, V1, V2       ; acc[l] += A*B
+
+        VINC    REG1             ; +VL*8
+        VINC    REG2             ; +VL*8
+        VDEC    REG0             ; -VL (satura en 0)
+        JNZ     start
+
+        VREDUCE REG4, V0         ; suma horizontal
+        STORE   REG4, [REG3]     ; Guardar suma parcial local
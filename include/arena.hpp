@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Arena "bump" para almacenamiento que vive lo mismo que el Simulator
+ * (tags/estados/datos de las cachés).
+ *
+ * - Pide bloques grandes y los reparte en trozos contiguos, alineados por
+ *   defecto a 64B (línea del host): cachés vecinas no comparten líneas.
+ * - No hay free individual: todo se devuelve al destruir la arena.
+ * - No es thread-safe: se usa al construir, antes de lanzar hilos.
+ */
+class Arena {
+public:
+  explicit Arena(std::size_t block_bytes = std::size_t{1} << 20);
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // 'bytes' en cero, alineados a 'align' (potencia de 2, <= 64)
+  void* allocate(std::size_t bytes, std::size_t align = 64);
+
+  // Arreglo de n T en cero (sólo tipos triviales: no se llaman destructores)
+  template <class T>
+  T* make_array(std::size_t n) {
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>);
+    static_assert(alignof(T) <= 64);
+    return static_cast<T*>(allocate(n * sizeof(T)));
+  }
+
+  std::size_t bytes_reserved() const { return reserved_; }  // pedido al sistema
+  std::size_t bytes_used()     const { return used_; }      // entregado (con padding)
+
+private:
+  struct Block {
+    std::byte*  ptr;
+    std::size_t size;
+  };
+
+  std::size_t        block_bytes_;
+  std::vector<Block> blocks_;
+  std::size_t        offset_   = 0;  // dentro del último bloque
+  std::size_t        reserved_ = 0;
+  std::size_t        used_     = 0;
+
+  void new_block(std::size_t min_bytes);
+};
+
+} // namespace sim
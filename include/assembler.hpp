@@ -16,7 +16,7 @@
 //   INC   REGx
 //   DEC   REGx
 //   MOVI  REGx, IMM64    // inmediato decimal o 0xHEX
-//   JNZ   LABEL          // usa REG0 como contador implícito
+//   JNZ   LABEL          // usa REG0 como contador implícito (PC resuelto al ensamblar)
 //
 // Notas rápidas:
 // - Registros válidos: REG0..REG7
@@ -38,6 +38,8 @@ public:
 private:
   // Convierte "REG0".."REG7" a su índice 0..7.
   static int         parse_reg(const std::string& token);
+  // Convierte "V0".."V3" a su índice.
+  static int         parse_vreg(const std::string& token);
 
   // Quita espacios al inicio y al final.
   static std::string trim(const std::string& s);
@@ -46,7 +48,8 @@ private:
   static bool        starts_with(const std::string& s, const std::string& p);
 };
 
-// Acceso a la tabla global de labels del último ensamblado (nombre -> índice).
+// Tabla global de labels del último ensamblado (nombre -> índice). Sólo
+// informativa: la ejecución usa Instr::target.
 std::unordered_map<std::string,int>& get_labels_singleton();
 
 } // namespace sim
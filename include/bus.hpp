@@ -1,56 +1,176 @@
 #pragma once
 #include "types.hpp"
+#include "sim_config.hpp"
+#include "snoop_filter.hpp"
 #include <queue>
+#include <deque>
 #include <vector>
 #include <mutex>
 #include <optional>
 #include <cstdint>
 #include <array>
+#include <atomic>
+#include <memory>
 #include <string>
 
 namespace sim {
 
 class Cache;
+class Directory;
+class Recorder;
 
 // Bus compartido (rollo MESI) bien simple:
 // - Las cachés empujan requests (BusRequest en types.hpp)
-// - El bus las difunde a todas (broadcast)
-// - step() procesa 1 request por tick (FIFO)
+// - El bus las difunde a todas (broadcast), o con directorio sólo a los sharers
+// - step() procesa hasta bus_ops_per_cycle requests por tick (FIFO)
 // - Se llevan métricas básicas (bytes y conteos por comando)
+// - BusModel::Split: la fase de dirección (snoop) ocurre al sacar la request de
+//   la cola; la de datos ocupa el bus bus_width bytes/ciclo tras la latencia del
+//   comando. Con bus_outstanding transacciones en vuelo no se aceptan más
+//   direcciones: los bytes pasan a ser un límite real y se ve el encolamiento.
+// - bus_banks > 1: interconexión entrelazada por dirección. Cada banco es un
+//   segmento con su cola, su arbitraje (bus_ops_per_cycle), su estado split y
+//   sus métricas; la línea L va al banco L % bus_banks. Como una línea vive en
+//   un solo banco, el orden de coherencia por línea se mantiene y los bancos
+//   pueden avanzar en paralelo (step_bank) si no comparten sets de caché.
 class Bus {
 public:
-  explicit Bus(std::vector<Cache*>& caches); // conectar cachés al crear el bus
+  Bus(std::vector<Cache*>& caches, const SimConfig& cfg); // conectar cachés al crear el bus
 
   // Permite reconectar/actualizar el set de cachés (útil en tests)
   void set_caches(const std::vector<Cache*>& caches);
 
-  // Encola una solicitud del bus (thread-safe con mtx_)
+  // Modo directorio: las requests van sólo a los sharers que indica 'dir'
+  // (nullptr = broadcast). El directorio lo posee el Simulator, junto a Memory.
+  void set_directory(Directory* dir) { dir_ = dir; }
+
+  // Grabación de cada request en la fase de dirección (nullptr = apagada)
+  void set_recorder(Recorder* rec) { rec_ = rec; }
+
+  // Snoop filter propio (SimConfig::snoop_filter); nullptr si está apagado
+  const SnoopFilter* snoop_filter() const { return filter_.get(); }
+
+  // Avisos de las cachés (fase PE, thread-safe): la línea entra/sale de 'pe'
+  void note_fill(PEId pe, Addr line_addr);
+  void note_evict(PEId pe, Addr line_addr);
+
+  // Encola una solicitud en el banco de su línea (thread-safe, lock por banco)
   void push_request(const BusRequest& req);
 
-  // Procesa una entrada de la cola y la difunde (llamar en el loop de sim)
+  // Un ciclo de todos los bancos, en orden (llamar en el loop de sim)
   void step();
 
-  // Métricas rápidas:
+  // Un ciclo de un solo banco. Bancos distintos pueden avanzar en hilos
+  // distintos siempre que parallel_safe() sea true.
+  void step_bank(std::size_t b);
+
+  std::size_t banks() const { return segs_.size(); }
+
+  // Los bancos no comparten sets de caché (num_sets % bus_banks == 0), así que
+  // sus snoops tocan líneas disjuntas y pueden correr a la vez
+  bool parallel_safe() const { return parallel_safe_; }
+
+  // Requests encoladas o en vuelo (0 = bus en reposo)
+  std::size_t pending() const;
+
+  // Estadísticas del modelo split-transaction (en ciclos de bus)
+  struct SplitStats {
+    std::uint64_t completed        = 0; // transacciones con fase de datos terminada
+    std::uint64_t queue_delay_sum  = 0; // encolada -> fase de dirección
+    std::uint64_t queue_delay_max  = 0;
+    std::uint64_t latency_sum      = 0; // encolada -> datos completos
+    std::uint64_t latency_max      = 0;
+    std::uint64_t data_busy_cycles = 0; // ciclos con el bus de datos ocupado
+    std::uint64_t addr_stalls      = 0; // ciclos con cola pero sin slot de transacción
+  };
+  bool          split()  const { return model_ == BusModel::Split; }
+  std::uint64_t cycles() const { return segs_.front()->cycle; }
+  SplitStats    split_stats() const;            // suma de todos los bancos
+
+  // Métricas de un banco (utilización = ciclos con actividad / ciclos)
+  struct BankStats {
+    std::uint64_t requests    = 0; // requests que pasaron por la fase de dirección
+    std::uint64_t bytes       = 0;
+    std::uint64_t busy_cycles = 0; // ciclos con dirección o datos en uso
+    std::size_t   max_depth   = 0; // pico de requests encoladas
+  };
+  BankStats bank_stats(std::size_t b) const;
+
+  // Métricas rápidas (suma de los bancos):
   std::uint64_t bytes() const;                 // bytes totales movidos por el bus
   std::uint64_t count_cmd(BusCmd cmd) const;   // cuántas veces vimos ese comando
   std::uint64_t flushes() const;               // intervenciones con datos (flush/write-back)
+  std::uint64_t snoops() const;                // llamadas a Cache::snoop
+  std::uint64_t p2p_msgs() const;              // mensajes punto a punto (directorio)
 
 private:
   std::vector<Cache*> caches_;         // cachés conectadas
-  std::queue<BusRequest> q_;           // cola FIFO de requests
-  std::mutex mtx_;                     // para push_request
 
-  // Estado para logs/debug
-  bool bus_was_empty_{true};
-  std::uint64_t next_tid_{1};          // id simple para requests (si se usa)
+  // Parámetros (de SimConfig)
+  std::size_t line_bytes_;
+  std::size_t ops_per_cycle_;
+  BusModel    model_;
+  std::size_t width_;
+  std::size_t max_outstanding_;
+  std::array<std::uint64_t, 5> lat_{};  // latencia por BusCmd (Split)
+  std::uint64_t lat_flush_;             // Rd/RdX servidos por otra caché
+  bool write_back_;                     // cachés write-back: grant/done al emisor
+  Protocol protocol_;                   // directorio: owner tras un BusRd
+  bool parallel_safe_;
 
-  // Métricas
-  std::uint64_t bus_bytes_{0};         // acumulado de bytes transferidos
-  std::array<std::uint64_t, 5> cmd_counts_{}; // contadores por BusCmd (0..4)
-  std::uint64_t flushes_{0};           // número de flush/intervenciones con datos
+  // Split-transaction: transacciones ya pasadas por la fase de dirección
+  struct InFlight {
+    BusRequest    req;
+    std::uint64_t ready;      // ciclo desde el que puede usar el bus de datos
+    std::uint64_t bytes_left; // bytes que aún faltan transferir
+    std::uint64_t addr_cycle; // ciclo de la fase de dirección
+  };
+
+  // Un banco del bus. Todo lo que sigue a 'mtx' lo toca sólo quien avanza el
+  // banco (fase bus), salvo la cola, que comparte con push_request.
+  struct alignas(64) Segment {
+    std::queue<BusRequest> q;          // cola FIFO de requests
+    mutable std::mutex mtx;            // para push_request / pending
+    std::deque<InFlight> inflight;
+    std::uint64_t cycle{0};
+    SplitStats split;
+    BankStats  stats;
+
+    // Estado para logs/debug
+    bool was_empty{true};
+
+    // MOESI/MESIF: línea en tránsito caché a caché (una request a la vez por banco)
+    std::vector<std::uint8_t> xfer;
+
+    // Métricas
+    std::uint64_t bus_bytes{0};         // acumulado de bytes transferidos
+    std::array<std::uint64_t, 5> cmd_counts{}; // contadores por BusCmd (0..4)
+    std::uint64_t flushes{0};           // número de flush/intervenciones con datos
+    std::uint64_t snoops{0};            // snoops efectivamente enviados a cachés
+    std::uint64_t p2p_msgs{0};          // modo directorio: req + forwards + acks + respuesta
+  };
+  std::vector<std::unique_ptr<Segment>> segs_;
+
+  std::atomic<std::uint64_t> next_tid_{1}; // id global de requests (todos los bancos)
+
+  Directory* dir_ = nullptr;
+  Recorder*  rec_ = nullptr;
+  std::unique_ptr<SnoopFilter> filter_;
+
+  std::size_t bank_of(Addr a) const { return (a / line_bytes_) % segs_.size(); }
+
+  // Resultado de la fase de dirección: bytes a transferir y si los dio otra caché
+  struct Outcome {
+    std::uint64_t bytes;
+    bool          from_peer;
+  };
 
   // Difunde la request a todas las cachés conectadas
-  void broadcast(const BusRequest& req);
+  Outcome broadcast(Segment& s, const BusRequest& req);
+
+  // Un ciclo de un banco con el modelo atómico / split-transaction
+  void step_atomic(Segment& s);
+  void step_split(Segment& s);
 };
 
 } // namespace sim
@@ -1,10 +1,14 @@
 #pragma once
 #include "config.hpp"
 #include "types.hpp"
-#include "cache_line.hpp"
+#include "arena.hpp"
+#include "tag_match.hpp"
+#include "replacement.hpp"
 #include "metrics.hpp"
 #include "memory.hpp"   // Asegura que Memory esté declarado
+#include "sim_config.hpp"
 #include <vector>
+#include <atomic>
 #include <optional>
 #include <utility>
 #include <cstdint>
@@ -14,6 +18,13 @@ namespace sim {
 
 class Bus;
 
+// Buffer del bus para una transferencia caché a caché (MOESI/MESIF): la caché
+// que provee copia ahí la línea en el snoop y el bus se la pasa al que pidió.
+struct LineXfer {
+  std::uint8_t* data   = nullptr;  // line_bytes, propiedad del bus
+  bool          filled = false;    // alguna caché proveyó la línea
+};
+
 /**
  * @brief Caché set-asociativa con coherencia MESI.
  *
@@ -25,29 +36,62 @@ class Bus;
  *   Es *write-through* (se escribe DRAM en cada store) y mantenemos la línea limpia (dirty=false).
  * - STORE miss: write-allocate + BusRdX, escribimos y la línea queda en M (limpia).
  *
+ * Con WritePolicy::WriteBack las líneas en M quedan sucias (DRAM se escribe al
+ * evictar o en un Flush por snoop), E->M es silencioso, y un miss o un S->M
+ * queda pendiente: la caché encola la request, el PE reintenta la instrucción
+ * cada tick (stalled()) y el bus concede la línea en la fase de dirección
+ * (bus_grant, datos de DRAM ya actualizada por los Flush). El acceso se hace
+ * ahí mismo, en el punto de orden de la coherencia, y el PE recibe el
+ * resultado cuando la transacción completa (bus_done): así dos PEs peleando
+ * por la misma línea no se la roban mutuamente antes de usarla.
+ *
+ * Con Protocol::MOESI / MESIF (sólo write-back) una caché con la línea en
+ * M/O (o E/F en MESIF) la provee por el bus en vez de que el que pide lea DRAM,
+ * y M pasa a O sin escribir DRAM (MOESI). Ver SimConfig::protocol.
+ *
  * El bus modela contabilidad de bytes (size) y flushes por intervención.
  */
 class Cache {
 public:
-  Cache(PEId owner, Bus& bus, Memory& mem);
+  // Tags/estados/datos salen de 'arena' (debe vivir más que la caché)
+  Cache(PEId owner, Bus& bus, Memory& mem, const SimConfig& cfg, Arena& arena);
 
   // Accesos locales (desde PE)
   bool load(Addr addr, std::size_t size, Word& out);   // devuelve hit/miss
   bool store(Addr addr, std::size_t size, Word value); // idem
+  // Lectura de hasta una línea (sin cruzarla) como UN acceso: un hit o un
+  // miss, una sola request al bus (cargas vectoriales)
+  bool load_block(Addr addr, std::size_t size, void* out);
+
+  std::size_t line_bytes() const { return line_bytes_; }
+
+  // Write-back: hay un miss/upgrade esperando al bus; el PE debe reintentar
+  bool stalled() const { return pending_.active; }
+
+  // Write-back (invocado por Bus): la request de este PE pasó por la fase de
+  // dirección ('shared' = otra caché tenía la línea; 'c2c' = línea provista
+  // por otra caché o nullptr si sale de DRAM) / terminó
+  void bus_grant(const BusRequest& req, bool shared, const std::uint8_t* c2c);
+  void bus_done(const BusRequest& req);
+
+  // Escribe a DRAM todas las líneas sucias (fin de corrida, fuera de métricas)
+  void write_back_all();
 
   // Reacciones a snoop (invocado por Bus)
-  // Retorna true si actuó (invalida/compartió/proveyó datos)
-  bool snoop(const BusRequest& req, std::optional<Word>& data_out);
+  // Retorna true si actuó (invalida/compartió/proveyó datos). Con MOESI/MESIF,
+  // si provee la línea la copia en 'xfer'.
+  bool snoop(const BusRequest& req, std::optional<Word>& data_out, LineXfer* xfer = nullptr);
 
   // Consultas
   const Metrics& metrics() const { return metrics_; }
+  const Replacement& replacement() const { return repl_; }
   void clear_metrics() { metrics_.reset(); }
 
   // Identificador del propietario (PE) para que el bus pueda evitar self-snoop
   PEId owner() const { return pe_; }
 
   // --- Nuevo: el Bus acredita tráfico al PE que origina la operación o provee Flush ---
-  void account_bus_bytes(std::uint64_t b) { metrics_.bus_bytes += b; }
+  void account_bus_bytes(std::uint64_t b) { bump(metrics_.bus_bytes, b); }
 
   /**
    * @brief Dump legible del contenido de la caché (para stepping/debug).
@@ -60,39 +104,89 @@ public:
                   bool dump_data = false) const;
 
 private:
-  struct Set {
-    std::vector<CacheLine> ways; // size = cfg::kCacheWays
-  };
+  // Contadores que se tocan en la fase bus (snoop / tráfico acreditado): con
+  // bancos del bus en paralelo, dos bancos pueden actualizar la misma caché
+  static void bump(std::uint64_t& c, std::uint64_t n = 1) {
+    std::atomic_ref<std::uint64_t>(c).fetch_add(n, std::memory_order_relaxed);
+  }
 
-  // --- Orden IMPORTA: primero dependencias y parámetros, luego 'sets_' ---
+  // --- Orden IMPORTA: primero dependencias y parámetros, luego el almacenamiento ---
   PEId      pe_;
   Bus&      bus_;
   Memory&   mem_;
   Metrics   metrics_;
 
-  // Parámetros de la caché (deben inicializarse ANTES de construir 'sets_')
-  std::size_t      line_bytes_ = cfg::kLineBytes;
-  std::size_t      num_lines_  = cfg::kCacheLines;
-  std::size_t      num_sets_   = cfg::kCacheLines / cfg::kCacheWays;
-
-  // Estructura de datos (se inicializa en el constructor, ya con params listos)
-  std::vector<Set> sets_;
+  // Parámetros de la caché (deben inicializarse ANTES de reservar el almacenamiento)
+  std::size_t      line_bytes_;
+  std::size_t      num_lines_;
+  std::size_t      ways_;
+  std::size_t      num_sets_;
+
+  // Búsqueda de tag (SimConfig::tag_match, resuelta al construir según el CPU).
+  // Por debajo de kSimdMinWays el loop inline gana a la llamada indirecta.
+  static constexpr std::size_t kSimdMinWays = 4;
+  tagmatch::FindFn find_fn_;
+
+  // Metadata de reemplazo por set/way (SimConfig::repl), también en la arena
+  Replacement repl_;
+
+  // Write-back: un solo miss/upgrade en vuelo (el PE queda parado hasta que termina)
+  bool write_back_;
+  Protocol protocol_;
+  struct Pending {
+    bool        active = false;
+    bool        done   = false;      // el bus completó la transacción
+    bool        store  = false;
+    BusCmd      cmd    = BusCmd::None;
+    Addr        addr   = 0;          // acceso que se reintenta
+    std::size_t size   = 0;
+    Word        value  = 0;          // store: a escribir (un load lee a pending_buf_)
+    Addr        line   = 0;          // base de la línea pedida
+    std::size_t set    = 0;
+    int         way    = -1;         // way reservada (inválida hasta el grant)
+  };
+  Pending pending_;
+  std::uint8_t* pending_buf_ = nullptr;  // line_bytes_: lo que un load leyó en el grant
+
+  // Almacenamiento SoA, contiguo y sacado de la arena. El slot set*ways_ + way
+  // indexa cada arreglo: la búsqueda de tag recorre ways_ tags seguidos y los
+  // datos de la línea son line_bytes_ bytes del slab.
+  std::uint64_t* tags_   = nullptr;
+  MESI*          states_ = nullptr;
+  std::uint8_t*  valid_  = nullptr;
+  std::uint8_t*  dirty_  = nullptr;
+  std::uint8_t*  data_   = nullptr;  // num_lines_ * line_bytes_
+
+  std::size_t   slot(std::size_t set_idx, int way) const { return set_idx * ways_ + static_cast<std::size_t>(way); }
+  std::uint8_t* line_data(std::size_t sl)       { return data_ + sl * line_bytes_; }
+  const std::uint8_t* line_data(std::size_t sl) const { return data_ + sl * line_bytes_; }
+  Addr slot_addr(std::size_t set_idx, std::size_t sl) const { return ((tags_[sl] * num_sets_) + set_idx) * line_bytes_; }
 
   // Helpers de mapeo
   std::pair<std::size_t, std::uint64_t> index_tag(Addr addr) const;
-  static inline Addr line_base(Addr addr) { return (addr / cfg::kLineBytes) * cfg::kLineBytes; }
-  static inline std::size_t line_offset(Addr addr) { return static_cast<std::size_t>(addr % cfg::kLineBytes); }
+  inline Addr line_base(Addr addr) const { return (addr / line_bytes_) * line_bytes_; }
+  inline std::size_t line_offset(Addr addr) const { return static_cast<std::size_t>(addr % line_bytes_); }
 
   int  find_way(std::size_t set_idx, std::uint64_t tag) const;
-  int  select_victim(std::size_t set_idx) const; // FIFO simple
+  int  select_victim(std::size_t set_idx);  // way inválida o la que elija repl_
 
   // Operaciones internas (respetan offset/tamaño dentro de la línea)
-  bool read_hit (std::size_t set_idx, int way, Addr addr, std::size_t size, Word& out);
+  bool read_hit (std::size_t set_idx, int way, Addr addr, std::size_t size, void* out);
   bool write_hit(std::size_t set_idx, int way, Addr addr, std::size_t size, Word value);
 
   // Miss handling (write-allocate, write-through)
-  bool handle_load_miss (Addr addr, std::size_t size, Word& out);
+  bool handle_load_miss (Addr addr, std::size_t size, void* out);
   bool handle_store_miss(Addr addr, std::size_t size, Word value);
+
+  // Write-back: evicta la víctima, encola 'cmd' y deja el miss pendiente
+  bool begin_miss(Addr addr, std::size_t size, BusCmd cmd, Word value);
+  // Write-back: ¿el reintento de 'addr' ya terminó? (false = stall; si es
+  // un load, 'out' recibe el dato leído en el grant)
+  bool resume_pending(Addr addr, void* out);
+
+  // Línea completa <-> DRAM
+  void write_line_to_mem (std::size_t sl, Addr base);
+  void read_line_from_mem(std::size_t sl, Addr base);
 };
 
 } // namespace sim
@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <iostream> // logs
 #include <syncstream>
+#include "log.hpp"
 
 namespace cfg
 {
@@ -10,6 +11,8 @@ namespace cfg
     #define SERR  std::osyncstream(std::cerr)
 
     // --- Topología básica ---
+    // Son los valores por defecto: en runtime se ajustan con sim::SimConfig
+    // (flags --pes, --ways, ... o --config archivo).
     inline constexpr std::size_t kNumPEs = 4;     // 4 PEs
     inline constexpr std::size_t kMemWords = 512; // 512 palabras de 64 bits
 
@@ -24,12 +27,19 @@ namespace cfg
     // Modo de simulación
     inline constexpr bool kCycleDriven = true;
 
-    // --- Flags de log rápidos ---
-    inline constexpr bool kLogSim   = true; // ciclos del simulador
-    inline constexpr bool kLogPE    = true; // accesos de cada PE
-    inline constexpr bool kLogCache = true; // hits/misses/writeback
-    inline constexpr bool kLogSnoop = true; // snoops/invalidaciones
-    inline constexpr bool kLogBus   = true; // cola/broadcast del bus
+    // --- Nivel de log (fijado al compilar: make LOG=N) ---
+    // 0 = nada (no queda código de log), 1 = simulador, 2 = + bus y PEs,
+    // 3 = + cachés y snoops (def.). Bus, PEs y cachés usan LOGF (binario,
+    // asíncrono: ver log.hpp); LOG_IF queda para los mensajes fuera del hot path.
+#ifndef MPMESI_LOG
+#define MPMESI_LOG 3
+#endif
+    inline constexpr int  kLogLevel = MPMESI_LOG;
+    inline constexpr bool kLogSim   = kLogLevel >= 1; // ciclos del simulador
+    inline constexpr bool kLogPE    = kLogLevel >= 2; // accesos de cada PE
+    inline constexpr bool kLogBus   = kLogLevel >= 2; // cola/broadcast del bus
+    inline constexpr bool kLogCache = kLogLevel >= 3; // hits/misses/writeback
+    inline constexpr bool kLogSnoop = kLogLevel >= 3; // snoops/invalidaciones
 
     inline constexpr bool kDemoContention = true; // fuerza contención para ver coherencia
 
@@ -37,11 +47,13 @@ namespace cfg
     // 1 operación por ciclo para ver claramente Upgr/Rd/Flush en orden.
     inline constexpr std::size_t kBusOpsPerCycle = 1; // (antes: 2)
 
-    // Macro simple de logging condicional
-    #define LOG_IF(flag, msg)        \
-        do {                         \
-            if (flag) {              \
-                SERR << msg << '\n'; \
-            }                        \
+    // Logging condicional con texto (sincrónico). Drena antes los LOGF
+    // pendientes para no desordenar la salida.
+    #define LOG_IF(flag, msg)            \
+        do {                             \
+            if constexpr (flag) {        \
+                ::sim::log::flush();     \
+                SERR << msg << '\n';     \
+            }                            \
         } while (0)
 } // namespace cfg
@@ -0,0 +1,50 @@
+#pragma once
+#include "types.hpp"
+#include "sim_config.hpp"
+#include "sharer_map.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace sim {
+
+/**
+ * Directorio MESI del lado de memoria (home): por cada línea cacheada guarda
+ * el bit-vector de sharers y el owner (el PE que responde a un BusRd: E/M, O
+ * en MOESI, F en MESIF; -1 si la provee la memoria).
+ *
+ * - Las cachés lo mantienen al día en cada fill/evicción (vía Bus::note_fill /
+ *   note_evict), así que es exacto: BusRdX/BusUpgr invalidan sólo a los
+ *   sharers y, con write-back, un BusRd va sólo al owner (o a ninguno).
+ * - Un E->M silencioso no cambia el owner: sigue siendo el mismo PE.
+ * - Las líneas viven en un SharerMap (disperso, con stripes): los PEs lo
+ *   actualizan en paralelo en la fase PE.
+ */
+class Directory {
+public:
+  explicit Directory(const SimConfig& cfg);
+
+  // Actualizaciones desde las cachés (fase PE, concurrentes)
+  void add_sharer(Addr line_addr, PEId pe) { map_.add(line_addr, pe); }
+  void remove_sharer(Addr line_addr, PEId pe);  // si era el owner, deja de serlo
+
+  // Lookup de una request (fase bus): copia de sharers y owner
+  SharerMap::Line lookup(Addr line_addr);
+
+  // Tras BusRdX/BusUpgr: queda sólo el que escribe, como owner
+  void grant_exclusive(Addr line_addr, PEId pe) { map_.keep_only(line_addr, pe); }
+  // Tras BusRd: fill exclusivo / forwarder (PE), o nadie (-1) si el owner bajó a S
+  void set_owner(Addr line_addr, int pe) { map_.set_owner(line_addr, pe); }
+
+  // Contadores
+  std::uint64_t lookups()        const { return lookups_.load(std::memory_order_relaxed); }
+  std::uint64_t evict_notices()  const { return evict_notices_.load(std::memory_order_relaxed); }
+  std::size_t   tracked_lines()  const { return map_.size(); }
+
+private:
+  SharerMap map_;
+
+  std::atomic<std::uint64_t> lookups_{0};
+  std::atomic<std::uint64_t> evict_notices_{0};
+};
+
+} // namespace sim
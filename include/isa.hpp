@@ -1,12 +1,11 @@
 #pragma once
 #include <cstdint>
-#include <string>
 #include <vector>
 
 namespace sim {
 
 // ISA mini: opcodes y formatos básicos (versión light).
-enum class OpCode {
+enum class OpCode : std::uint8_t {
   LOAD,   // LOAD  Rd, [Rs]
   STORE,  // STORE Rs, [Rd]
   FMUL,   // FMUL  Rd, Ra, Rb
@@ -15,18 +14,37 @@ enum class OpCode {
   INC,    // INC   R
   DEC,    // DEC   R
   MOVI,   // MOVI  Rd, IMM64
-  JNZ     // JNZ   label  (usa REG0 como contador)
+  JNZ,    // JNZ   label  (usa REG0 como contador)
+
+  // Vectoriales: V0..V3 de VL doubles, VL = palabras por línea (máx. 16).
+  // Los lanes más allá de REG0 (si 0 < REG0 < VL) quedan en 0: la cola del
+  // vector no necesita un loop escalar aparte.
+  VLOAD,   // VLOAD   Vd, [Rs]    (la línea (o lo que falte de REG0) como un acceso)
+  VFMA,    // VFMA    Vd, Va, Vb  (Vd += Va*Vb por lane)
+  VREDUCE, // VREDUCE Rd, Va      (suma horizontal de Va -> Rd como double)
+  VZERO,   // VZERO   Vd
+  VINC,    // VINC    R           (puntero + VL*8)
+  VDEC,    // VDEC    R           (R - VL, satura en 0)
+
+  // Superinstrucciones: el Assembler no las acepta, las arma Processor al
+  // cargar el programa (caché de bloques básicos)
+  FMULADD, // FMUL rd, ra, rb + FADD (target = rd2 | ra2 << 8 | rb2 << 16)
+  DECJNZ   // DEC rd + JNZ target
 };
 
-// Instrucción cruda (sin microdetalles).
+// Instrucción predecodificada: tamaño fijo y sin strings. El Assembler ya
+// resolvió los labels, así que JNZ lleva el PC destino.
 struct Instr {
-  OpCode op{};        // operación
-  int rd = 0;         // destino (en STORE: registro con dirección destino)
-  int ra = 0;         // operando A (en LOAD/STORE: registro fuente)
-  int rb = 0;         // operando B (FMUL/FADD/REDUCE)
-  std::string label;  // para JNZ
-  std::uint64_t imm=0;// para MOVI (decimal o 0xHEX)
+  OpCode        op{};       // operación
+  std::uint8_t  rd = 0;     // destino (en STORE: registro con dirección destino)
+  std::uint8_t  ra = 0;     // operando A (en LOAD/STORE: registro fuente)
+  std::uint8_t  rb = 0;     // operando B (FMUL/FADD/REDUCE/VFMA)
+  std::uint32_t target = 0; // JNZ: PC destino
+  std::uint64_t imm = 0;    // MOVI (decimal o 0xHEX)
 };
+static_assert(sizeof(Instr) == 16, "Instr debe quedar en 16 bytes");
+
+inline constexpr int kNumVRegs = 4;  // V0..V3
 
 // Programa = lista plana de instrucciones.
 struct Program {
@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace sim::log {
+
+/**
+ * Logger binario asíncrono para el hot path (caché, bus, PEs).
+ *
+ * - LOGF(flag, fmt, args...) no formatea nada: copia el puntero al formato y
+ *   los argumentos crudos (64 bits c/u) a un ring SPSC del hilo que loguea.
+ * - Un hilo drenador junta los rings, ordena por número de secuencia global
+ *   y recién ahí formatea y escribe a stderr. flush() drena en el acto (el
+ *   simulador lo llama antes de imprimir resultados y en cada step).
+ * - 'flag' es constexpr (cfg::kLog*): con el nivel de log apagado la llamada
+ *   no genera código (ni evalúa los argumentos).
+ *
+ * Formato: "{}" valor, "{x}" hex, "{f}" double con 6 decimales, "{pes}"
+ * máscara de PE0..PE63 + cuántos más, 2 argumentos ("PE1,PE3,+2" o "none"),
+ * "{regs}" terna empaquetada (rd | ra << 8 | rb << 16) como "R4, R4, R7".
+ * 'fmt' y los argumentos const char* tienen que ser literales o tablas
+ * estáticas: sólo se guarda el puntero.
+ */
+
+enum class Arg : std::uint8_t { None = 0, U64, I64, F64, Str };
+
+inline constexpr std::size_t kMaxArgs = 6;
+
+struct Record {
+  const char*   fmt;
+  std::uint32_t seq;    // orden global entre hilos
+  std::uint32_t types;  // Arg de cada argumento, 4 bits c/u
+  std::uint64_t args[kMaxArgs];
+};
+static_assert(sizeof(Record) == 64, "Record debe ocupar una línea");
+
+// Ring de un hilo: el hilo escribe en head, el drenador consume desde tail
+struct Ring {
+  static constexpr std::uint64_t kCap = 1024;  // registros (potencia de 2)
+  alignas(64) std::atomic<std::uint64_t> head{0};
+  alignas(64) std::atomic<std::uint64_t> tail{0};
+  std::atomic<bool> retired{false};            // el hilo terminó
+  Record buf[kCap];
+};
+
+inline std::atomic<std::uint32_t> g_seq{0};
+inline thread_local Ring*         t_ring = nullptr;
+
+Ring& register_thread();         // crea y registra el ring del hilo
+void  wait_for_space(Ring& r);   // ring lleno: despierta al drenador y espera
+void  wake_drainer();
+void  flush();                   // drena y formatea todo lo publicado
+
+template <class T>
+constexpr Arg arg_of() {
+  using U = std::decay_t<T>;
+  if constexpr (std::is_same_v<U, bool>)          return Arg::U64;
+  else if constexpr (std::is_integral_v<U>)       return std::is_signed_v<U> ? Arg::I64 : Arg::U64;
+  else if constexpr (std::is_floating_point_v<U>) return Arg::F64;
+  else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) return Arg::Str;
+  else static_assert(sizeof(U) == 0, "LOGF: sólo enteros, double y const char* estáticos");
+}
+
+template <class T>
+std::uint64_t bits_of(const T& v) {
+  constexpr Arg a = arg_of<T>();
+  if constexpr (a == Arg::F64) {
+    const double d = static_cast<double>(v);
+    std::uint64_t b;
+    std::memcpy(&b, &d, sizeof b);
+    return b;
+  } else if constexpr (a == Arg::Str) {
+    return reinterpret_cast<std::uintptr_t>(static_cast<const char*>(v));
+  } else if constexpr (a == Arg::I64) {
+    return static_cast<std::uint64_t>(static_cast<std::int64_t>(v));
+  } else {
+    return static_cast<std::uint64_t>(v);
+  }
+}
+
+template <class... A>
+constexpr std::uint32_t pack_types() {
+  std::uint32_t t = 0, sh = 0;
+  ((t |= static_cast<std::uint32_t>(arg_of<A>()) << sh, sh += 4), ...);
+  return t;
+}
+
+template <class... A>
+void emit(const char* fmt, const A&... a) {
+  static_assert(sizeof...(A) <= kMaxArgs, "LOGF: máximo 6 argumentos");
+  Ring& r = t_ring ? *t_ring : register_thread();
+  const std::uint64_t h    = r.head.load(std::memory_order_relaxed);
+  const std::uint64_t used = h - r.tail.load(std::memory_order_acquire);
+  if (used >= Ring::kCap) wait_for_space(r);
+
+  Record& rec = r.buf[h & (Ring::kCap - 1)];
+  rec.fmt   = fmt;
+  rec.types = pack_types<A...>();
+  [[maybe_unused]] std::size_t i = 0;
+  ((rec.args[i++] = bits_of(a)), ...);
+  rec.seq = g_seq.fetch_add(1, std::memory_order_relaxed);
+  r.head.store(h + 1, std::memory_order_release);
+
+  if (used + 1 == Ring::kCap / 2) wake_drainer();  // medio ring: que drene antes de llenarse
+}
+
+} // namespace sim::log
+
+// Log binario condicional (hot path)
+#define LOGF(flag, ...)                   \
+  do {                                    \
+    if constexpr (flag) {                 \
+      ::sim::log::emit(__VA_ARGS__);      \
+    }                                     \
+  } while (0)
@@ -0,0 +1,40 @@
+#pragma once
+#include "memory.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sim {
+
+// Imagen binaria de memoria: segmentos (dirección base + bytes crudos).
+//
+//   [0]      "MPMIMG01"                       magic (8 bytes)
+//   [8]      u64 nsegs
+//   [16]     nsegs x { u64 base, u64 bytes, u64 file_off }
+//   ...      datos de cada segmento en file_off (el writer los alinea a 4 KiB)
+//
+// Todo little-endian. Los segmentos con base y file_off alineados a página se
+// mapean (mmap MAP_PRIVATE) directo en Memory: cargar cuesta lo que los page
+// faults de lo que se toque, y las escrituras son copy-on-write del kernel.
+namespace memimage {
+
+struct LoadStats {
+  std::size_t segments     = 0;
+  std::size_t mapped_bytes = 0;   // páginas prestadas por el mmap
+  std::size_t copied_bytes = 0;   // bordes no alineados (copiados)
+};
+
+// Carga 'path' en 'mem'. Lanza std::runtime_error si el archivo no es una
+// imagen válida o un segmento cae fuera del espacio de direcciones.
+LoadStats load(const std::string& path, Memory& mem);
+
+// Escribe las páginas presentes de 'mem' (las contiguas en un solo segmento).
+// Devuelve la cantidad de segmentos. Lanza std::runtime_error si falla.
+std::size_t save(const std::string& path, const Memory& mem);
+
+// Verifica que 'path' se pueda crear/escribir sin tocar su contenido (si no
+// existía, no queda creado). Lanza std::runtime_error si no se puede.
+void check_writable(const std::string& path);
+
+} // namespace memimage
+} // namespace sim
@@ -1,6 +1,11 @@
 #pragma once
 #include "config.hpp"
 #include "types.hpp"
+#include "sim_config.hpp"
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <memory>
 #include <vector>
 #include <mutex>
 
@@ -9,25 +14,106 @@ namespace sim {
 /**
  * Memoria simple de palabras de 64b. 
  * - read64/write64: acceso alineado a cfg::kWordBytes (8B).
+ * - read_line/write_line: línea completa de caché con un solo memcpy (fills,
+ *   write-backs y Flush).
  * - read_aligned/write_aligned: API genérica con alineamiento configurable.
  *   Útil para el requisito de “definir alineamiento”. Devuelve true/false.
+ *
+ * El lock está particionado por línea (stripes, como el Directory): PEs que
+ * tocan líneas distintas no se pisan, y una línea nunca cruza dos stripes.
+ *
+ * El backing store es disperso: una tabla de páginas de dos niveles (páginas
+ * de 4 KiB, tablas de 1024 páginas) que se asignan en la primera escritura.
+ * mem-words sólo fija el tamaño del espacio de direcciones (pueden ser GB):
+ * la memoria real sigue a las páginas tocadas y leer una no asignada da 0.
+ * Una imagen binaria (mem_image.hpp) puede prestar páginas de un archivo
+ * mapeado en memoria (map_pages): se usan tal cual, sin copiarlas.
  */
 class Memory {
 public:
-  Memory();
+  static constexpr std::size_t kPageBytes = 4096;
+
+  explicit Memory(const SimConfig& cfg);
+  ~Memory();
+
+  Memory(const Memory&) = delete;
+  Memory& operator=(const Memory&) = delete;
+
+  // Tamaño del espacio de direcciones en palabras de 64b
+  std::size_t words() const { return bytes_ / cfg::kWordBytes; }
+
+  // Páginas asignadas (footprint real = resident_pages() * kPageBytes)
+  std::size_t resident_pages() const { return resident_.load(std::memory_order_relaxed); }
+  // Páginas prestadas por map_pages (las trae el kernel a medida que se tocan)
+  std::size_t mapped_pages()   const { return mapped_; }
+
+  // Instala 'pages' páginas de 'data' (alineado a página, p.ej. un mmap
+  // MAP_PRIVATE) a partir de 'base' sin copiarlas; 'owner' las mantiene vivas.
+  // Las que ya estaban asignadas se copian. Sólo en la inicialización.
+  void map_pages(Addr base, std::uint8_t* data, std::size_t pages, std::shared_ptr<void> owner);
+
+  // Llama f(base) por cada página presente (asignada o mapeada), en orden creciente
+  template <class F>
+  void for_each_resident_page(F&& f) const {
+    for (std::size_t i = 0; i < l1_.size(); ++i) {
+      const L2* t = l1_[i].load(std::memory_order_acquire);
+      if (!t) continue;
+      for (std::size_t j = 0; j < kL2Entries; ++j)
+        if (t->pages[j].load(std::memory_order_acquire))
+          f(static_cast<Addr>(((i << kL2Bits) | j) * kPageBytes));
+    }
+  }
 
   // Accesos a palabra de 64 bits (alineados a cfg::kWordBytes)
   Word read64(Addr addr) const;
   void write64(Addr addr, Word value);
 
+  // Línea completa (base alineada a line_bytes). Lo que cae fuera de la
+  // memoria se lee como 0 y no se escribe, igual que read64/write64.
+  void read_line(Addr base, void* dst) const;
+  void write_line(Addr base, const void* src);
+
   // --- API genérica con alineamiento definible (bytes) ---
   // Nota: retorna false si (addr o size) no respetan el alineamiento o hay OOB.
   bool read_aligned(Addr addr, void* dst, std::size_t bytes, std::size_t align) const;
   bool write_aligned(Addr addr, const void* src, std::size_t bytes, std::size_t align);
 
 private:
-  std::vector<Word> mem_;          // backing store
-  mutable std::mutex mtx_;         // permite lockear en métodos const
+  static constexpr std::size_t kStripes = 64;
+  struct alignas(64) Stripe {
+    mutable std::mutex m;
+  };
+
+  // Tabla de páginas: l1_[addr >> 22] -> L2, L2.pages[(addr >> 12) & 1023] -> página.
+  // Los punteros se publican con CAS, así que la búsqueda no toma locks.
+  static constexpr std::size_t kPageBits  = 12;
+  static constexpr std::size_t kL2Bits    = 10;
+  static constexpr std::size_t kL2Entries = std::size_t{1} << kL2Bits;
+  struct Page {
+    alignas(64) std::uint8_t bytes[kPageBytes];
+  };
+  struct L2 {
+    std::array<std::atomic<Page*>, kL2Entries> pages{};
+    std::bitset<kL2Entries> borrowed;  // de map_pages: no se liberan
+  };
+
+  std::size_t bytes_;              // tamaño del espacio de direcciones
+  std::size_t line_bytes_;
+  std::vector<std::atomic<L2*>> l1_;
+  std::atomic<std::size_t> resident_{0};
+  std::size_t mapped_ = 0;
+  std::vector<std::shared_ptr<void>> owners_;  // dueños de las páginas prestadas
+  mutable std::array<Stripe, kStripes> stripes_;  // permite lockear en métodos const
+
+  std::mutex& lock_of(Addr addr) const { return stripes_[(addr / line_bytes_) % kStripes].m; }
+
+  // Página que contiene 'addr': nullptr si no está asignada / la asigna
+  L2&                 table_for(Addr addr);
+  const std::uint8_t* page_for_read(Addr addr) const;
+  std::uint8_t*       page_for_write(Addr addr);
+
+  // Bytes de [addr, addr + bytes) que caen dentro del espacio de direcciones
+  std::size_t in_range(Addr addr, std::size_t bytes) const;
 };
 
 } // namespace sim
@@ -8,6 +8,8 @@ namespace sim {
  * - loads/stores/hits/misses/invalidations/flushes: ya estaban.
  * - bus_bytes: tráfico de bus *atribuido a este PE* (nuevo: lo actualiza el Bus).
  * - transiciones MESI: contadores simples para análisis.
+ * - dram_*: tráfico con DRAM, aparte del de bus (write-through vs write-back).
+ * - repl_*: decisiones de la política de reemplazo (comparar políticas por carga).
  */
 struct Metrics {
   std::uint64_t loads = 0;
@@ -27,6 +29,21 @@ struct Metrics {
   std::uint64_t trans_m_to_s = 0;
   std::uint64_t trans_x_to_i = 0;  // cualquier {S,E,M} -> I por inval
 
+  // ---- DRAM / write-back ----
+  std::uint64_t writebacks       = 0;  // líneas sucias escritas a DRAM al evictarlas
+  std::uint64_t dram_read_bytes  = 0;  // fills desde DRAM
+  std::uint64_t dram_write_bytes = 0;  // write-through + write-backs + flush por snoop
+  std::uint64_t stall_cycles     = 0;  // write-back: ticks esperando al bus (miss/upgrade)
+
+  // ---- MOESI / MESIF: transferencias caché a caché ----
+  std::uint64_t c2c_fills           = 0;  // líneas recibidas de otra caché (no de DRAM)
+  std::uint64_t c2c_supplies        = 0;  // líneas provistas a otra caché
+  std::uint64_t dram_writes_avoided = 0;  // bytes que MESI habría escrito por Flush
+
+  // ---- Reemplazo ----
+  std::uint64_t repl_evictions     = 0;  // misses con el set lleno: víctima elegida por la política
+  std::uint64_t repl_invalid_fills = 0;  // misses que usaron una way inválida (sin decisión)
+
   void reset() { *this = {}; }
 };
 
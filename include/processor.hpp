@@ -1,15 +1,17 @@
 #pragma once
 #include "types.hpp"
 #include "isa.hpp"
+#include "vec_ops.hpp"
 #include <vector>
 #include <memory>
 #include <optional>
 #include <string>
-#include <unordered_map>
 
 namespace sim {
 
 class Cache;
+class TraceReader;
+class Recorder;
 
 // Modo de ejecución: por traza o ejecutando ISA
 enum class ExecMode { Trace, ISA };
@@ -18,9 +20,11 @@ class Processor {
 public:
   // Construcción: id del PE y su caché
   Processor(PEId id, Cache& cache);
+  ~Processor();  // Def en .cpp (TraceReader incompleto aquí)
 
   // Carga de trabajo
   void load_trace(const std::vector<Access>& trace); // lista de accesos (addr, load/store)
+  void load_trace(std::unique_ptr<TraceReader> reader); // traza binaria en streaming
   void load_program(const Program& p);               // programa ya ensamblado
   void load_program_from_string(const std::string& asm_source); // asm en texto
   void load_program_from_file(const std::string& path);         // asm desde archivo
@@ -37,6 +41,22 @@ public:
 
   PEId id() const { return id_; }
 
+  // Lanes de los registros vectoriales (palabras por línea, máx. vecops::kMaxLanes)
+  std::size_t   vector_lanes()   const { return vl_; }
+  std::uint64_t vector_retired() const { return vec_retired_; }  // instrucciones V* completadas
+
+  // Grabación de los accesos completados (nullptr = apagada)
+  void set_recorder(Recorder* rec) { rec_ = rec; }
+
+  // Superinstrucciones: pares fusionados al cargar el programa (ver build_blocks)
+  void set_fusion(bool on) { fusion_ = on; }
+  struct FusionStats {
+    std::uint64_t retired = 0;  // instrucciones ISA completadas (fusionadas o no)
+    std::uint64_t fmuladd = 0;  // FMUL+FADD ejecutados como uno
+    std::uint64_t decjnz  = 0;  // DEC+JNZ ejecutados como uno
+  };
+  const FusionStats& fusion_stats() const { return fstats_; }
+
 private:
   // Helpers para ISA
   static double        as_double(std::uint64_t v);   // reinterpretar u64 como f64
@@ -47,9 +67,6 @@ private:
   std::uint64_t mem_load64(std::uint64_t addr);
   void          mem_store64(std::uint64_t addr, std::uint64_t val);
 
-  // Labels del ensamblador (para JNZ)
-  static const std::unordered_map<std::string,int>& labels_map();
-
   // Estado
   PEId        id_;
   Cache&      cache_;
@@ -58,11 +75,42 @@ private:
   // ISA
   Program     prog_{};
   std::size_t pc_ = 0;
+
+  // Caché de bloques básicos: copia de prog_.code con los pares fusionables
+  // (las dos instrucciones en el mismo bloque) reescritos como FMULADD/DECJNZ
+  // en la 1ra posición. El par se ejecuta en un tick y el tick de la 2da queda
+  // "debido" (owed_), así los ciclos simulados no cambian.
+  std::vector<Instr> blocks_{};
+  bool          fusion_ = true;
+  std::uint32_t owed_   = 0;
+  FusionStats   fstats_{};
+  void build_blocks();
   std::uint64_t reg_[8] = {0};
+  std::uint64_t reduce_i_   = 0;    // REDUCE en curso (write-back puede frenarlo)
+  double        reduce_acc_ = 0.0;
+
+  // Registros vectoriales: VL lanes útiles (el resto siempre en 0)
+  alignas(64) double vreg_[kNumVRegs][vecops::kMaxLanes] = {};
+  std::size_t   vl_        = 1;
+  std::size_t   vload_off_ = 0;     // VLOAD en curso: bytes ya leídos (cruce de línea)
+  std::uint64_t vec_retired_ = 0;
 
-  // Traza
+  // Traza: en memoria (trace_) o en streaming desde archivo (reader_)
   std::vector<Access> trace_{};
   std::size_t pc_trace_ = 0;
+  std::unique_ptr<TraceReader> reader_;
+  std::optional<Access> cur_;        // acceso en curso (write-back puede frenarlo)
+  std::uint32_t gap_left_  = 0;      // ticks de cómputo que faltan antes de emitirlo
+  bool          trace_eof_ = false;
+
+  bool next_access(Access& out);     // próximo acceso de la fuente activa
+  void exec_access();                // modo traza: 1 tick
+
+  // Grabación
+  Recorder*     rec_       = nullptr;
+  std::uint64_t rec_issue_ = 0;      // tick en que se emitió el acceso en curso
+  // Load: 'inout' recibe 'size' bytes | Store: 'inout' apunta al Word a escribir
+  void          cache_access(AccessType type, Addr addr, std::size_t size, void* inout);
 };
 
 } // namespace sim
@@ -0,0 +1,96 @@
+#pragma once
+#include "sim_config.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace sim {
+
+/**
+ * Perfil del host (--profile tsc|perf): en qué se va el tiempo real del loop
+ * de ticks, medido con el TSC (rdtsc, ~20 ciclos por lectura).
+ *
+ * - Hilo principal, por tick: fase PE (desde que abre el tick hasta que
+ *   terminaron los PEs), fase bus, y "entre ticks" (loop de run, --sample).
+ * - Por hilo del host: cuánto estuvo dentro de Processor::step / del bus
+ *   (trabajo) y el resto de los ticks (barrera, espera de la otra fase).
+ *   Cada hilo toma su slot la primera vez que mide (thread_local), así sirve
+ *   igual con threads, pool o inline.
+ * - Con 'perf', cada hilo abre además cycles y cache-misses de usuario con
+ *   perf_event_open (sólo Linux); si el kernel no lo permite se avisa y se
+ *   sigue sólo con el TSC.
+ *
+ * Con --profile off el simulador no crea el Profiler: un branch por paso.
+ */
+class Profiler {
+public:
+  enum Work { PE = 0, Bus = 1, kWork };
+
+  explicit Profiler(ProfileMode mode);
+  ~Profiler();  // cierra los contadores de perf
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  static std::uint64_t stamp() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+
+  // Hilo principal: empieza un run (lo previo no cuenta como "entre ticks")
+  void run_begin()     { last_ = 0; }
+  // Hilo principal: bordes del tick (siempre en este orden)
+  void tick_begin()    { const auto t = stamp(); if (last_) between_ += t - last_; last_ = t; }
+  void pe_phase_done() { const auto t = stamp(); pe_phase_ += t - last_; last_ = t; }
+  void tick_end()      { const auto t = stamp(); bus_phase_ += t - last_; last_ = t; ++ticks_; }
+
+  // Cualquier hilo: suma 'dt' de trabajo del tipo 'w' al slot del hilo
+  void add_work(Work w, std::uint64_t dt) { slot().work[w] += dt; }
+
+  // Reporte: instr = instrucciones (o accesos de traza) simuladas en el run
+  void report(std::ostream& os, std::uint64_t instr, const char* unit) const;
+
+private:
+  // Un slot por hilo del host, en su propia línea (lo escribe sólo su dueño)
+  struct alignas(64) Slot {
+    std::uint64_t work[kWork] = {};
+    int           fd_cycles = -1;  // perf_event_open, líder del grupo (se lee por acá)
+    int           fd_misses = -1;  // miembro del grupo de fd_cycles
+  };
+
+  ProfileMode   mode_;
+  std::uint64_t gen_;              // distingue este Profiler en los thread_local
+  std::uint64_t tsc0_;
+  std::chrono::steady_clock::time_point wall0_;
+
+  // Hilo principal
+  std::uint64_t last_      = 0;
+  std::uint64_t pe_phase_  = 0;
+  std::uint64_t bus_phase_ = 0;
+  std::uint64_t between_   = 0;
+  std::uint64_t ticks_     = 0;
+
+  mutable std::mutex                 m_;      // slots_ (alta de hilos)
+  std::vector<std::unique_ptr<Slot>> slots_;  // en orden de alta (0 = primero en medir)
+  int                                perf_errno_ = 0;
+
+  inline static thread_local Slot*        t_slot_ = nullptr;
+  inline static thread_local std::uint64_t t_gen_  = 0;
+
+  Slot& slot() { return t_gen_ == gen_ ? *t_slot_ : add_slot(); }
+  Slot& add_slot();
+  void  open_perf(Slot& s);
+};
+
+} // namespace sim
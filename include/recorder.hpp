@@ -0,0 +1,76 @@
+#pragma once
+#include "types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Grabación de una corrida (--record FILE) en el formato de trace.hpp:
+ *   - cada acceso de un PE que se completa (tick de emisión, gap, addr, tipo)
+ *     en chunks Delta de ese PE, así el archivo sirve tal cual para --trace;
+ *   - cada BusRequest que pasa por Bus::broadcast en chunks Bus.
+ *
+ * Un buffer codificado por PE y por banco del bus: en cada fase los toca un
+ * solo hilo (el que avanza ese PE o ese banco), así que grabar es codificar
+ * unos bytes sin locks. El mutex sólo protege el archivo cuando un buffer se
+ * llena y se vuelca como chunk.
+ */
+class Recorder {
+public:
+  // Lanza std::runtime_error si no se puede crear el archivo
+  Recorder(const std::string& path, std::size_t num_pes, std::size_t bus_banks);
+  ~Recorder();  // close() (sin lanzar)
+
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+  // Tick actual (lo fija el Simulator entre ticks, antes de abrir las fases)
+  void          set_tick(std::uint64_t t) { tick_.store(t, std::memory_order_relaxed); }
+  std::uint64_t tick() const              { return tick_.load(std::memory_order_relaxed); }
+
+  // Fase PE: acceso completado, emitido en 'issue_tick'
+  void access(PEId pe, std::uint64_t issue_tick, AccessType type, Addr addr, std::size_t size);
+  // Fase bus: request en la fase de dirección del banco 'bank'
+  void bus(std::size_t bank, const BusRequest& req, bool shared, bool from_peer);
+
+  // Vuelca los buffers y cierra (idempotente)
+  void close();
+
+  std::uint64_t accesses()      const { return accesses_; }
+  std::uint64_t bus_records()   const { return bus_records_; }
+  std::uint64_t bytes_written() const { return bytes_written_; }
+
+private:
+  static constexpr std::size_t kChunkBytes = 64 * 1024;  // payload por chunk
+
+  struct alignas(64) Stream {
+    std::vector<std::uint8_t> buf;
+    std::uint32_t count     = 0;
+    std::uint64_t prev_tick = 0;  // estado delta del chunk en curso
+    Addr          prev_addr = 0;
+    std::uint64_t next_free = 1;  // PE: primer tick tras su último acceso (para el gap)
+    std::uint64_t total     = 0;
+  };
+
+  std::string path_;
+  std::ofstream out_;
+  std::mutex    out_mtx_;
+  std::vector<Stream> pes_;
+  std::vector<Stream> banks_;
+  std::atomic<std::uint64_t> tick_{0};
+
+  std::uint64_t accesses_      = 0;  // válidos tras close()
+  std::uint64_t bus_records_   = 0;
+  std::uint64_t bytes_written_ = 0;
+
+  void flush(Stream& s, std::uint32_t pe, std::uint32_t encoding);
+};
+
+} // namespace sim
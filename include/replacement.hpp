@@ -0,0 +1,77 @@
+#pragma once
+#include "arena.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace sim {
+
+// Política de reemplazo de las cachés:
+// - LRU:    LRU exacto (marca de uso por way)
+// - PLRU:   tree-PLRU (ways-1 bits por set; ways potencia de 2, <= 64)
+// - FIFO:   la línea que entró primero
+// - Random: xorshift por caché (semilla = PE, reproducible)
+// - SRRIP:  RRIP estático (RRPV de 2 bits, inserta en "lejano")
+// - BRRIP:  RRIP bimodal (inserta en "distante", 1/32 en "lejano")
+// - DRRIP:  set dueling SRRIP vs BRRIP con un contador PSEL
+enum class ReplPolicy { LRU, PLRU, FIFO, Random, SRRIP, BRRIP, DRRIP };
+
+/**
+ * Estado de reemplazo de UNA caché: la metadata por set/way sale de la misma
+ * arena que los tags de la caché y no lleva locks. La tocan dos fases:
+ * - fase PE: el PE dueño (on_hit, on_fill de write-through, victim).
+ * - fase bus (write-back): Cache::bus_grant hace el on_fill del miss
+ *   pendiente desde Bus::broadcast.
+ * Alcanza con que nunca haya dos a la vez: la barrera del tick separa las
+ * fases, y cada caché tiene un solo miss pendiente, así que en la fase bus
+ * un único segmento (banco) le da el grant aunque los bancos corran en
+ * paralelo.
+ *
+ * La caché avisa on_hit/on_fill y pide victim() sólo con el set lleno (las
+ * ways inválidas se llenan primero, sin consultar a la política).
+ */
+class Replacement {
+public:
+  Replacement(ReplPolicy policy, std::size_t sets, std::size_t ways, Arena& arena, std::uint64_t seed);
+
+  void        on_hit (std::size_t set, std::size_t way);
+  void        on_fill(std::size_t set, std::size_t way);
+  std::size_t victim (std::size_t set);
+
+  ReplPolicy policy() const { return policy_; }
+
+  // DRRIP: ¿los followers insertan como BRRIP? (PSEL > mitad)
+  bool followers_use_brrip() const { return psel_ > kPselMax / 2; }
+  // Inserciones en RRPV "distante" (BRRIP o followers de DRRIP en modo BRRIP)
+  std::uint64_t distant_inserts() const { return distant_inserts_; }
+
+private:
+  static constexpr std::uint8_t  kRrpvMax  = 3;     // RRPV de 2 bits
+  static constexpr std::uint32_t kPselMax  = 1023;  // PSEL de 10 bits
+  static constexpr std::uint32_t kBrripOdds = 32;   // BRRIP: 1/32 a "lejano"
+
+  ReplPolicy  policy_;
+  std::size_t sets_, ways_;
+
+  std::uint64_t* stamp_ = nullptr;  // LRU/FIFO: marca por way (sets*ways)
+  std::uint64_t* tree_  = nullptr;  // PLRU: bits del árbol por set
+  std::uint8_t*  rrpv_  = nullptr;  // RRIP: valor de re-referencia por way
+  std::uint64_t  clock_ = 0;
+  std::uint64_t  rng_;
+
+  // DRRIP: cada 'duel_period_' sets hay un líder SRRIP (resto 0) y uno BRRIP (resto 1)
+  std::size_t   duel_period_ = 0;
+  std::uint32_t psel_ = kPselMax / 2;
+  std::uint64_t distant_inserts_ = 0;
+
+  std::uint64_t next_random();
+  std::size_t   slot(std::size_t set, std::size_t way) const { return set * ways_ + way; }
+
+  bool brrip_for(std::size_t set);  // DRRIP: ¿este set inserta como BRRIP?
+  std::size_t rrip_victim(std::size_t set);
+  std::size_t plru_victim(std::size_t set) const;
+  void        plru_touch(std::size_t set, std::size_t way);
+};
+
+const char* to_string(ReplPolicy p);
+
+} // namespace sim
@@ -0,0 +1,75 @@
+#pragma once
+#include "metrics.hpp"
+#include "sim_config.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+class Bus;
+class Cache;
+
+/**
+ * Series de tiempo (--sample FILE): cada 'every' ticks escribe, por PE, lo que
+ * pasó en el intervalo (deltas de Metrics: hits, misses, invalidaciones,
+ * bytes de bus, transiciones MESI) y los totales del bus en el intervalo.
+ *
+ * - CSV: una fila por PE e intervalo; las columnas bus_* se repiten en las
+ *   filas del mismo intervalo (cada fila se entiende sola).
+ * - JSON lines: un objeto por intervalo con "bus" y el arreglo "pe".
+ *
+ * Se llama entre ticks (fases cerradas), así que lee las métricas sin locks.
+ * Una muestra es copiar los contadores de cada caché y formatear con
+ * to_chars a un buffer que se vuelca al llenarse: se puede dejar prendido.
+ */
+class Sampler {
+public:
+  // Lanza std::runtime_error si no se puede crear el archivo
+  Sampler(const std::string& path, SampleFormat fmt, std::size_t every, std::size_t num_pes);
+  ~Sampler();  // close() (sin lanzar)
+
+  Sampler(const Sampler&) = delete;
+  Sampler& operator=(const Sampler&) = delete;
+
+  // ¿Toca muestrear al terminar el tick 'tick'? (un compare por tick)
+  bool due(std::uint64_t tick) const { return tick >= next_; }
+
+  void sample(std::uint64_t tick, const std::vector<std::unique_ptr<Cache>>& caches, const Bus& bus);
+
+  // Último intervalo (si quedó a medias) y cierre del archivo (idempotente).
+  // Lanzan std::runtime_error si falló alguna escritura (archivo truncado)
+  void finish(std::uint64_t tick, const std::vector<std::unique_ptr<Cache>>& caches, const Bus& bus);
+  void close();
+
+  std::uint64_t samples()       const { return samples_; }
+  std::uint64_t bytes_written() const { return bytes_written_; }
+
+private:
+  static constexpr std::size_t kFlushBytes = 64 * 1024;
+
+  struct BusSnap {
+    std::uint64_t bytes = 0, rd = 0, rdx = 0, upgr = 0, flushes = 0;
+  };
+
+  std::string   path_;
+  std::ofstream out_;
+  SampleFormat  fmt_;
+  std::size_t   every_;
+  std::uint64_t next_;
+  std::uint64_t last_tick_ = 0;
+  std::vector<Metrics> prev_;
+  BusSnap       prev_bus_{};
+  std::string   buf_;
+
+  std::uint64_t samples_       = 0;
+  std::uint64_t bytes_written_ = 0;
+
+  void write_header();
+  void flush_buf();
+};
+
+} // namespace sim
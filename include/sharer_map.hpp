@@ -0,0 +1,87 @@
+#pragma once
+#include "types.hpp"
+#include "sim_config.hpp"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+
+// Conjunto de PEs como bit-vector (1 bit por PE, escala a cualquier nº de PEs).
+class SharerSet {
+public:
+  SharerSet() = default;
+  explicit SharerSet(std::size_t num_pes) : w_((num_pes + 63) / 64, 0) {}
+
+  void set(PEId pe)        { w_[pe >> 6] |=  (std::uint64_t{1} << (pe & 63)); }
+  void reset(PEId pe)      { w_[pe >> 6] &= ~(std::uint64_t{1} << (pe & 63)); }
+  bool test(PEId pe) const { return (w_[pe >> 6] >> (pe & 63)) & 1u; }
+
+  bool        none()  const;
+  std::size_t count() const;
+
+  // Deja sólo 'pe' (si estaba)
+  void keep_only(PEId pe);
+
+  // Llama f(pe) por cada bit encendido, en orden creciente
+  template <class F>
+  void for_each(F&& f) const {
+    for (std::size_t i = 0; i < w_.size(); ++i) {
+      for (std::uint64_t b = w_[i]; b; b &= b - 1)
+        f(static_cast<PEId>(i * 64 + static_cast<std::size_t>(__builtin_ctzll(b))));
+    }
+  }
+
+private:
+  std::vector<std::uint64_t> w_;
+};
+
+/**
+ * Mapa línea -> sharers (+ owner) compartido por Directory y SnoopFilter.
+ *
+ * - Disperso: sólo líneas presentes en alguna caché; una línea sin sharers
+ *   se borra.
+ * - Particionado en stripes con su propio mutex: las cachés lo actualizan en
+ *   paralelo en la fase PE y los bancos del bus lo consultan en la fase bus.
+ * - El owner (el PE que responde a un BusRd: E/M, O en MOESI, F en MESIF) lo
+ *   usa sólo Directory; el filtro no lo lee.
+ */
+class SharerMap {
+public:
+  struct Line {
+    SharerSet sharers;
+    int       owner = -1;  // -1: ninguno (provee la memoria)
+  };
+
+  explicit SharerMap(const SimConfig& cfg);
+
+  void add(Addr line_addr, PEId pe);        // fill
+  void remove(Addr line_addr, PEId pe);     // evicción (si era el owner, deja de serlo)
+  void keep_only(Addr line_addr, PEId pe);  // BusRdX/BusUpgr: el resto invalidado, 'pe' owner
+  void set_owner(Addr line_addr, int pe);   // -1 lo borra; no-op si la línea no está
+
+  // Copia de la línea (sin sharers ni owner si nadie la tiene)
+  Line get(Addr line_addr) const;
+
+  std::size_t num_pes() const { return num_pes_; }
+  std::size_t size()    const;  // líneas con al menos un sharer
+
+private:
+  static constexpr std::size_t kStripes = 64;
+  struct alignas(64) Stripe {
+    mutable std::mutex m;
+    std::unordered_map<Addr, Line> map; // clave: índice de línea
+  };
+
+  std::size_t line_bytes_;
+  std::size_t num_pes_;
+  std::array<Stripe, kStripes> stripes_;
+
+  Addr          line_index(Addr a) const { return a / line_bytes_; }
+  Stripe&       stripe_of(Addr idx)       { return stripes_[idx % kStripes]; }
+  const Stripe& stripe_of(Addr idx) const { return stripes_[idx % kStripes]; }
+};
+
+} // namespace sim
@@ -0,0 +1,159 @@
+#pragma once
+#include "config.hpp"
+#include "tag_match.hpp"
+#include "replacement.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+// Sincronización del loop de ticks en el engine multihilo:
+// - Barrier: barrera sense-reversing con spin acotado + futex (tick_barrier.hpp)
+// - CondVar: mutex + condition_variable (el camino original, como fallback)
+enum class SyncMode { Barrier, CondVar };
+
+// Cómo se ejecutan los PEs de cada tick:
+// - Threads: 1 hilo de SO por PE + 1 para el bus (sincronizados según SyncMode)
+// - Pool:    pool de workers (≈ núcleos del host) con work stealing; el bus
+//            corre en el hilo que avanza el tick, después de todos los PEs
+// - Inline:  todo en el hilo que avanza el tick, sin sincronización:
+//            PE0..PEn-1 en orden y luego el bus. Determinista (mismo orden de
+//            requests en el bus en cada corrida); ideal para configs chicas.
+enum class Engine { Threads, Pool, Inline };
+
+// Cómo se resuelve la coherencia de cada request:
+// - Snoop:     el bus la difunde a todas las cachés (broadcast)
+// - Directory: el directorio (junto a Memory) la manda sólo a los sharers
+enum class CoherenceMode { Snoop, Directory };
+
+// Política de escritura de las cachés:
+// - WriteThrough: cada store va también a DRAM y las líneas quedan limpias (original)
+// - WriteBack:    las líneas en M quedan sucias y van a DRAM al evictarse o al
+//                 hacer Flush por un snoop. Un miss (o S->M) deja al PE esperando
+//                 hasta que el bus procesa la request (los datos pueden estar
+//                 sucios en otra caché)
+enum class WritePolicy { WriteThrough, WriteBack };
+
+// Protocolo de coherencia (requieren write-back salvo MESI):
+// - MESI:  un BusRd sobre M hace Flush a DRAM y el que pide lee DRAM (original)
+// - MOESI: M pasa a O (sucia, compartida) y provee la línea caché a caché sin
+//          escribir DRAM; O también provee en BusRd/BusRdX
+// - MESIF: un solo sharer en F (el último en leer) provee la línea; E/M también
+//          proveen y el que pide queda en F
+enum class Protocol { MESI, MOESI, MESIF };
+
+// Modelo temporal del bus:
+// - Atomic: cada request se completa en el ciclo en que se procesa (original)
+// - Split:  split-transaction; fase de dirección (snoop) y fase de datos
+//           separadas, ancho de bus en bytes/ciclo, varias transacciones en
+//           vuelo y latencia por comando
+enum class BusModel { Atomic, Split };
+
+// Formato de la serie de tiempo de --sample (sampler.hpp):
+// - Csv:   una fila por PE e intervalo (con encabezado)
+// - Jsonl: un objeto JSON por intervalo y por línea
+enum class SampleFormat { Csv, Jsonl };
+
+// Perfil del host (profiler.hpp):
+// - Off:  sin medir (def.)
+// - Tsc:  tiempos por fase y por hilo con rdtsc
+// - Perf: además cycles y cache-misses por hilo (perf_event_open, Linux)
+enum class ProfileMode { Off, Tsc, Perf };
+
+/**
+ * Configuración en tiempo de ejecución del simulador.
+ *
+ * Los valores por defecto salen de config.hpp (cfg::k*), así que un
+ * SimConfig{} se comporta igual que la versión con constantes fijas.
+ * Se puede ajustar por CLI (--pes 64) o con un archivo (--config sim.cfg):
+ *
+ *   # comentario
+ *   pes        = 64
+ *   ways       = 4
+ *   lines      = 64
+ *   line-bytes = 64
+ *
+ * Las claves del archivo son las mismas que los flags sin el "--".
+ * Cualquier error (clave desconocida, valor inválido) lanza std::runtime_error.
+ */
+struct SimConfig {
+  // --- Topología ---
+  std::size_t num_pes   = cfg::kNumPEs;
+  std::size_t mem_words = cfg::kMemWords;
+
+  // --- Geometría de caché privada ---
+  std::size_t cache_ways  = cfg::kCacheWays;
+  std::size_t cache_lines = cfg::kCacheLines;
+  std::size_t line_bytes  = cfg::kLineBytes;
+  TagMatch    tag_match   = TagMatch::Auto;  // búsqueda de tag: escalar o SIMD
+  ReplPolicy  repl        = ReplPolicy::LRU; // política de reemplazo
+  WritePolicy write_policy = WritePolicy::WriteThrough;
+  Protocol    protocol     = Protocol::MESI;
+
+  // --- Bus ---
+  std::size_t bus_ops_per_cycle = cfg::kBusOpsPerCycle;
+  BusModel      bus_model = BusModel::Atomic;
+  std::size_t   bus_width       = 8;  // Split: bytes por ciclo en la fase de datos
+  std::size_t   bus_outstanding = 4;  // Split: transacciones en vuelo como máximo
+  std::size_t   lat_rd    = 10;       // Split: ciclos dirección->datos de un BusRd desde DRAM
+  std::size_t   lat_rdx   = 10;       // Split: idem BusRdX
+  std::size_t   lat_upgr  = 1;        // Split: BusUpgr (sólo permisos)
+  std::size_t   lat_flush = 4;        // Split: Rd/RdX cuando los datos vienen de otra caché
+  std::size_t   bus_banks   = 1;      // segmentos entrelazados por línea (línea % bancos)
+  std::size_t   bus_threads = 0;      // hilos para avanzar bancos en paralelo (0 = núcleos)
+  CoherenceMode coherence = CoherenceMode::Snoop;
+  bool          snoop_filter = false; // filtro inclusivo delante del broadcast (modo snoop)
+
+  // --- Engine y sincronización del loop de ticks ---
+  Engine      engine     = Engine::Threads;
+  std::size_t workers    = 0;    // hilos del pool (0 = núcleos del host)
+  SyncMode    sync       = SyncMode::Barrier;
+  std::size_t spin_limit = 2000; // iteraciones de spin antes de estacionarse en el futex
+
+  // --- Intérprete ---
+  bool        fuse       = true;  // superinstrucciones (FMUL+FADD, DEC+JNZ)
+
+  // --- Problema de ejemplo (dot product) ---
+  std::size_t dot_n = 16;
+
+  // --- Imagen de memoria y volcados ---
+  std::string   mem_image;              // imagen binaria mapeada al iniciar (mem_image.hpp)
+  std::string   snapshot;               // al terminar, la memoria se escribe como imagen
+  bool          dump_mem    = true;     // volcado de la memoria inicial...
+  std::uint64_t dump_mem_lo = 0;        // ... sólo de [lo, hi)
+  std::uint64_t dump_mem_hi = ~std::uint64_t{0};
+
+  // --- Modo trace-driven ---
+  std::string   trace;                  // traza binaria (trace.hpp) en vez de asm/dot
+  std::string   record;                 // graba accesos y requests del bus (recorder.hpp)
+
+  // --- Series de tiempo ---
+  std::string   sample;                 // métricas por intervalo (sampler.hpp)
+  std::size_t   sample_every  = 1000;   // ticks por intervalo
+  SampleFormat  sample_format = SampleFormat::Csv;
+
+  // --- Perfil del host ---
+  ProfileMode   profile = ProfileMode::Off;
+
+  std::size_t num_sets() const { return cache_lines / cache_ways; }
+
+  // Asigna una clave (formato de archivo/CLI sin "--"). Lanza si no existe.
+  void set(const std::string& key, const std::string& value);
+
+  // Carga "clave = valor" desde archivo (comentarios con '#' o ';').
+  void load_file(const std::string& path);
+
+  // Consume los flags de configuración de argv y devuelve el resto
+  // (p.ej. --step o el path del .asm) en orden, para que main los trate.
+  std::vector<std::string> parse_args(int argc, char** argv);
+
+  // Chequea coherencia de la geometría. Lanza std::runtime_error si no cuadra.
+  void validate() const;
+
+  // Ayuda de los flags soportados (para --help).
+  static const char* usage();
+};
+
+} // namespace sim
@@ -1,11 +1,13 @@
 #pragma once
 /**
  * Simulator: orquesta Bus, Memoria, Caches y PEs.
- * Multihilo: 1 hilo por PE + 1 para el Bus. Avanza por "ticks": PEs -> Bus.
- * Barrera por tick para evitar carreras y bloqueos.
+ * Multihilo: 1 hilo por PE + 1 para el Bus (Engine::Threads), o un pool de
+ * workers con work stealing (Engine::Pool). Avanza por "ticks": PEs -> Bus.
+ * Barrera por tick para evitar carreras y bloqueos: por defecto una barrera
+ * spin+futex (SyncMode::Barrier); mutex+condvar queda como fallback.
  */
 
-#include <array>
+#include <vector>
 #include <memory>
 #include <optional>
 #include <cstddef>
@@ -14,28 +16,43 @@
 #include <mutex>
 #include <condition_variable>
 #include <functional>
+#include <atomic>
+#include <chrono>
 
 #include "config.hpp"
 #include "types.hpp"
 #include "memory.hpp"
+#include "arena.hpp"
+#include "directory.hpp"
+#include "sim_config.hpp"
+#include "tick_barrier.hpp"
+#include "work_pool.hpp"
 
 namespace sim {
 
 class Cache;
 class Bus;
 class Processor;
+class Recorder;
+class Sampler;
+class Profiler;
 struct Program;
 
 class Simulator {
 public:
-  Simulator();
+  explicit Simulator(const SimConfig& cfg = SimConfig{});
   ~Simulator();  // Def en .cpp (evita incomplete-type con unique_ptr)
 
   // ---- Inicialización / carga de programas
+  // Layout de A/B/partial_sums para cfg.dot_n: con los defaults (N=16) queda
+  // 0x000/0x100/0x200, y crece (alineado a línea) si N o los PEs no entran
+  struct DotLayout { Addr baseA, baseB, basePS; };
+  static DotLayout dot_layout(const SimConfig& cfg);
   void init_dot_problem(std::size_t N, Addr baseA, Addr baseB, Addr basePS);
   void load_demo_traces();
   void load_program_all(const Program &p);
   void load_program_all_from_file(const std::string &path);
+  void load_trace_all_from_file(const std::string &path);  // modo trace-driven (trace.hpp)
 
   // ---- Ejecución
   void run_cycles(std::size_t cycles);
@@ -50,12 +67,25 @@ public:
   void dump_cache(std::size_t pe, std::optional<std::size_t> only_set = std::nullopt) const;
   void dump_regs(std::size_t pe) const;
 
+  const SimConfig& config() const { return cfg_; }
+  std::size_t      ticks_run() const { return ticks_run_; }  // ticks avanzados hasta ahora
+
 private:
+  // ------------- Configuración (antes que los componentes que dimensiona) -------------
+  SimConfig cfg_;
+
+  // Almacenamiento de las cachés (antes que ellas: se destruye después)
+  Arena arena_;
+
   // ------------- Componentes -------------
   std::unique_ptr<Bus> bus_;
-  std::array<std::unique_ptr<Cache>,     cfg::kNumPEs> caches_;
-  std::array<std::unique_ptr<Processor>, cfg::kNumPEs> pes_;
+  std::vector<std::unique_ptr<Cache>>     caches_;
+  std::vector<std::unique_ptr<Processor>> pes_;
   Memory mem_;
+  std::unique_ptr<Directory> dir_;  // sólo en CoherenceMode::Directory (home junto a Memory)
+  std::unique_ptr<Recorder>  rec_;  // sólo con --record
+  std::unique_ptr<Sampler>   sampler_;  // sólo con --sample
+  std::unique_ptr<Profiler>  prof_;     // sólo con --profile tsc|perf
 
   // ------------- Estado "dot product" (agrupa lo que antes eran globals) -------------
   struct DotCfg {
@@ -66,11 +96,15 @@ private:
     Addr basePS{0};
   } dot_;
 
+  // Modo trace-driven: no hay dot product que reducir ni verificar al final
+  bool          trace_mode_     = false;
+  std::uint64_t trace_accesses_ = 0;
+
   // ------------- Multihilo -------------
   enum class Phase { Idle, RunPE, RunBus, Halt };
 
   // Hilos (uno por PE + uno para el Bus)
-  std::array<std::thread, cfg::kNumPEs> pe_threads_;
+  std::vector<std::thread> pe_threads_;
   std::thread bus_thread_;
 
   // Estado compartido
@@ -86,26 +120,50 @@ private:
   bool        bus_done_      = false;
 
   // Último tick procesado por cada hilo (para no repetir/correr dos veces)
-  std::array<std::size_t, cfg::kNumPEs> pe_last_tick_{};
+  std::vector<std::size_t> pe_last_tick_;
   std::size_t bus_last_tick_ = 0;
 
   bool threads_started_ = false;
 
+  // --- SyncMode::Barrier ---
+  // tick_barrier_: main + PEs + bus (apertura de fase PE y fin de fase PE)
+  // bus_barrier_:  main + bus (fin de fase bus; los PEs no necesitan esperarla)
+  std::unique_ptr<SpinParkBarrier> tick_barrier_;
+  std::unique_ptr<SpinParkBarrier> bus_barrier_;
+  std::atomic<bool> halt_{false};
+
+  // --- Engine::Pool ---
+  std::unique_ptr<WorkStealingPool> pool_;
+
+  // --- Bancos del bus en paralelo (Engine::Threads; Pool reutiliza pool_) ---
+  std::unique_ptr<WorkStealingPool> bus_pool_;
+
+  // Ticks avanzados (para reportar ticks/s)
+  std::size_t ticks_run_ = 0;
+
   // Lanzado/parada de hilos y avance de 1 tick (bloqueante)
   void start_threads();
   void stop_threads();
-  void advance_one_tick_blocking();
+  void advance_one_tick_blocking();  // fases del tick + muestra de --sample
+  void run_tick_phases();
+  void step_bus();  // fase bus: bancos en paralelo si se puede, si no Bus::step()
+  void step_pe(std::size_t pe);  // fase PE: un paso del PE si no terminó
 
-  // Cuerpos de los hilos
+  // Cuerpos de los hilos (mutex/condvar)
   void worker_pe(std::size_t pe_idx);
   void worker_bus();
 
+  // Cuerpos de los hilos (barrera spin+futex)
+  void worker_pe_barrier(std::size_t pe_idx);
+  void worker_bus_barrier();
+
   // --------- Helpers factoriza2 ----------
   // 1) Finalización común: reduce y printea resultado
   void do_final_reduction_and_print();
   // 2) Métricas y bus
   void dump_metrics() const;
   void dump_bus_stats() const;
+  void dump_tick_rate(std::size_t ticks, std::chrono::steady_clock::duration wall) const;
   // 3) Dumps por PE + referencia CPU
   double ref_dot_cpu() const;
   void dump_all_pes_and_ref() const;
@@ -118,7 +176,7 @@ private:
   // Helper de iteración (inline por ser template)
   template <class F>
   inline void for_each_pe(F&& f) {
-    for (std::size_t pe = 0; pe < cfg::kNumPEs; ++pe) f(pe);
+    for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe) f(pe);
   }
 };
 
@@ -0,0 +1,50 @@
+#pragma once
+#include "types.hpp"
+#include "sim_config.hpp"
+#include "sharer_map.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace sim {
+
+/**
+ * Snoop filter inclusivo del Bus: por cada línea presente en alguna caché
+ * guarda qué PEs pueden tenerla. El broadcast sigue siendo el modelo (mismo
+ * tráfico de bus), pero sólo se llama a Cache::snoop de esos PEs: el resto
+ * terminaría en "línea no presente" tras pagar index_tag + find_way.
+ *
+ * - Inclusivo: toda línea en caché está en el filtro (fill/evicción lo
+ *   mantienen), así que nunca se saltea un snoop necesario.
+ * - Las líneas viven en un SharerMap (stripes con mutex propio): las cachés
+ *   lo actualizan en paralelo en la fase PE.
+ */
+class SnoopFilter {
+public:
+  explicit SnoopFilter(const SimConfig& cfg);
+
+  // Mantenimiento desde las cachés (fase PE)
+  void on_fill(Addr line_addr, PEId pe)  { map_.add(line_addr, pe); }
+  void on_evict(Addr line_addr, PEId pe) { map_.remove(line_addr, pe); }
+
+  // Fase bus: PEs (distintos de 'source') a los que hay que hacer snoop.
+  // Actualiza hits/misses/snoops evitados.
+  SharerSet lookup(Addr line_addr, PEId source);
+
+  // Tras BusRdX/BusUpgr los demás quedaron invalidados
+  void keep_only(Addr line_addr, PEId pe) { map_.keep_only(line_addr, pe); }
+
+  std::uint64_t hits()           const { return hits_.load(std::memory_order_relaxed); }
+  std::uint64_t misses()         const { return misses_.load(std::memory_order_relaxed); }
+  std::uint64_t snoops_avoided() const { return avoided_.load(std::memory_order_relaxed); }
+  std::size_t   tracked_lines()  const { return map_.size(); }
+
+private:
+  SharerMap map_;
+
+  // Fase bus: atómicos porque los bancos del bus pueden consultar a la vez
+  std::atomic<std::uint64_t> hits_{0};     // lookup con al menos otro PE
+  std::atomic<std::uint64_t> misses_{0};   // nadie más la tiene: cero snoops
+  std::atomic<std::uint64_t> avoided_{0};  // snoops que el broadcast habría hecho de más
+};
+
+} // namespace sim
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace sim {
+
+// Implementación de la búsqueda de tag dentro de un set:
+// - Auto:   la mejor que soporte el CPU (AVX2 > SSE4.1 > escalar)
+// - Scalar: loop simple (siempre disponible)
+// - Sse41:  2 tags por comparación (pcmpeqq)
+// - Avx2:   4 tags por comparación (vpcmpeqq)
+enum class TagMatch { Auto, Scalar, Sse41, Avx2 };
+
+namespace tagmatch {
+
+// Tag de las ways inválidas: ningún tag real llega a este valor (haría falta
+// una dirección de 2^64 líneas), así la búsqueda no necesita mirar 'valid'.
+inline constexpr std::uint64_t kNoTag = ~std::uint64_t{0};
+
+// Índice del primer tags[i] == tag en [0, n), o -1
+using FindFn = int (*)(const std::uint64_t* tags, std::size_t n, std::uint64_t tag);
+
+// Escalar sin saltos por way: arma la máscara de coincidencias (bloques de 64)
+// y toma la primera. Con pocas ways evita el mispredict de "en qué way pegó".
+inline int find_scalar(const std::uint64_t* tags, std::size_t n, std::uint64_t tag) {
+  for (std::size_t i = 0; i < n; i += 64) {
+    const std::size_t e = n - i < 64 ? n - i : 64;
+    std::uint64_t m = 0;
+    for (std::size_t j = 0; j < e; ++j)
+      m |= static_cast<std::uint64_t>(tags[i + j] == tag) << j;
+    if (m) return static_cast<int>(i) + __builtin_ctzll(m);
+  }
+  return -1;
+}
+
+int find_sse41 (const std::uint64_t* tags, std::size_t n, std::uint64_t tag);
+int find_avx2  (const std::uint64_t* tags, std::size_t n, std::uint64_t tag);
+
+// ¿El CPU del host soporta 'm'? (Auto y Scalar siempre)
+bool supported(TagMatch m);
+
+// Resuelve Auto a la mejor disponible. Lanza std::runtime_error si se pide
+// explícitamente una que el CPU no soporta.
+TagMatch resolve(TagMatch m);
+
+FindFn      function(TagMatch m);  // m ya resuelto (no Auto)
+const char* name(TagMatch m);
+
+} // namespace tagmatch
+} // namespace sim
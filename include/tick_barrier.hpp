@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sim {
+
+/**
+ * Barrera sense-reversing sin locks para el loop de ticks.
+ *
+ * - El último en llegar reinicia el contador e invierte el "sentido"
+ *   (aquí una época de 32 bits: el sentido es su paridad, y al ser un
+ *   contador nunca se confunde un tick con el anterior).
+ * - Los demás hacen spin acotado (spin_limit iteraciones con pause) y, si
+ *   la barrera no se abre, se estacionan en un futex sobre la época.
+ * - El que abre sólo hace la syscall de wake si hay alguien estacionado.
+ *
+ * Con más participantes que núcleos el spin sólo roba CPU al que falta
+ * llegar, así que en ese caso conviene spin_limit = 0 (park directo).
+ */
+class SpinParkBarrier {
+public:
+  SpinParkBarrier(std::size_t participants, std::uint32_t spin_limit);
+
+  SpinParkBarrier(const SpinParkBarrier&) = delete;
+  SpinParkBarrier& operator=(const SpinParkBarrier&) = delete;
+
+  // Bloquea hasta que lleguen todos los participantes.
+  void arrive_and_wait();
+
+  std::size_t participants() const { return participants_; }
+
+private:
+  // Cada campo caliente en su propia línea para no hacer false sharing
+  alignas(64) std::atomic<std::uint32_t> remaining_;
+  alignas(64) std::atomic<std::uint32_t> epoch_{0};     // palabra del futex
+  alignas(64) std::atomic<std::uint32_t> sleepers_{0};  // hilos estacionados
+
+  std::uint32_t participants_;
+  std::uint32_t spin_limit_;
+};
+
+} // namespace sim
@@ -0,0 +1,158 @@
+#pragma once
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Traza binaria de accesos para el modo trace-driven (--trace).
+ *
+ *   [0]  "MPTRACE1"                                     magic (8 bytes)
+ *   ...  chunks: { u32 pe, u32 count, u32 bytes, u32 encoding } + payload
+ *
+ * Cada chunk tiene 'count' registros de un solo PE ('bytes' de payload, así los
+ * demás PEs lo saltan sin decodificarlo). Todo little-endian. Los accesos de un
+ * PE se ejecutan en el orden del archivo.
+ *
+ *   Raw (0):   registros de 16B { u64 addr, u32 gap, u8 type (0 load / 1 store), u8 size, u16 0 }
+ *              (TraceWriter; p.ej. trazas sintéticas de tools/trace_gen.cpp)
+ *   Delta (1): { varint dtick, varint gap, zigzag varint daddr, u8 type | size << 1 }
+ *   Bus (2):   { varint dtick, u8 cmd | shared << 4 | from_peer << 5, varint source,
+ *                zigzag varint daddr, varint size }   (chunks con pe = kTraceBusPe)
+ *
+ * En Delta/Bus tick y addr son diferencias con el registro anterior del mismo
+ * chunk (el primero, contra 0): cada chunk se decodifica solo. Los chunks Bus
+ * los escribe el Recorder (recorder.hpp); el modo traza los ignora.
+ */
+enum class TraceEncoding : std::uint32_t { Raw = 0, Delta = 1, Bus = 2 };
+
+inline constexpr char          kTraceMagic[8] = {'M', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+inline constexpr std::uint32_t kTraceBusPe    = 0xFFFFFFFFu;  // "PE" de los chunks de bus
+
+// Registro decodificado (para herramientas: ver tools/trace_dump.cpp)
+struct TraceEvent {
+  bool          bus  = false;    // false: acceso de un PE | true: BusRequest
+  PEId          pe   = 0;        // PE del acceso / emisor de la request
+  std::uint64_t tick = 0;        // 0 en chunks Raw (no lo guardan)
+  Access        acc{};           // acceso (bus == false)
+  BusCmd        cmd  = BusCmd::None;  // request (bus == true)
+  Addr          addr = 0;
+  std::size_t   size = 0;
+  bool          shared    = false;    // alguna caché actuó en el snoop
+  bool          from_peer = false;    // los datos los dio otra caché
+};
+
+// Archivo mapeado en memoria (sólo lectura, compartido por los TraceReader)
+class TraceFile {
+public:
+  // Lanza std::runtime_error si no se puede abrir o no es una traza válida
+  explicit TraceFile(const std::string& path);
+  ~TraceFile();
+
+  TraceFile(const TraceFile&) = delete;
+  TraceFile& operator=(const TraceFile&) = delete;
+
+  const std::uint8_t* data() const { return data_; }
+  std::size_t         size() const { return size_; }
+
+  // Recorridos al abrir (sólo headers de chunks)
+  std::size_t   pes()         const { return pes_; }       // mayor PE + 1
+  std::uint64_t accesses()    const { return accesses_; }
+  std::uint64_t bus_records() const { return bus_records_; }
+
+  // Recorre todos los registros en el orden del archivo
+  template <class F>
+  void for_each_event(F&& f) const;
+
+private:
+  const std::uint8_t* data_ = nullptr;
+  std::size_t   size_        = 0;
+  std::size_t   pes_         = 0;
+  std::uint64_t accesses_    = 0;
+  std::uint64_t bus_records_ = 0;
+};
+
+// Decodificación de un chunk (trace.cpp). 'p' avanza hasta el próximo registro;
+// tick/addr son el estado delta del chunk (arrancan en 0). Lanza
+// std::runtime_error si un registro se sale del payload ('end').
+struct TraceChunkState {
+  TraceEncoding       enc;
+  PEId                pe;
+  const std::uint8_t* end;
+  std::uint64_t       tick = 0;
+  Addr                addr = 0;
+};
+void decode_trace_event(const std::uint8_t*& p, TraceChunkState& st, TraceEvent& out);
+
+// Lector de los accesos de un PE: salta los chunks ajenos y decodifica de a
+// bloques en un buffer propio, pidiendo al kernel el bloque siguiente por
+// adelantado (madvise WILLNEED).
+class TraceReader {
+public:
+  TraceReader(std::shared_ptr<const TraceFile> file, PEId pe);
+
+  // Próximo acceso del PE; false al terminar la traza
+  bool next(Access& out);
+
+private:
+  static constexpr std::size_t kBatch = 256;
+
+  std::shared_ptr<const TraceFile> file_;
+  PEId          pe_;
+  std::size_t   off_      = 8;   // próximo header de chunk (tras el magic)
+  const std::uint8_t* rec_ = nullptr;  // próximo registro del chunk actual
+  std::uint32_t left_     = 0;   // registros que faltan del chunk actual
+  TraceChunkState st_{TraceEncoding::Raw, 0, nullptr};
+  std::array<Access, kBatch> buf_{};
+  std::size_t   pos_ = 0, len_ = 0;
+
+  bool refill();
+  bool next_chunk();
+};
+
+// Escritor de chunks Raw (lo usa tools/trace_gen.cpp): un buffer por PE que
+// se vuelca como chunk al llenarse
+class TraceWriter {
+public:
+  // Lanza std::runtime_error si no se puede crear el archivo
+  explicit TraceWriter(const std::string& path, std::size_t chunk_records = 4096);
+  ~TraceWriter();  // close() (sin lanzar)
+
+  void append(PEId pe, const Access& a);
+  // Vuelca lo pendiente; lanza std::runtime_error si falló alguna escritura
+  void close();
+
+private:
+  std::string   path_;
+  std::ofstream out_;
+  std::size_t   chunk_records_;
+  std::vector<std::vector<Access>> bufs_;
+
+  void flush(PEId pe);
+};
+
+template <class F>
+void TraceFile::for_each_event(F&& f) const {
+  struct Hdr { std::uint32_t pe, count, bytes, encoding; };
+  TraceEvent ev;
+  for (std::size_t off = sizeof(kTraceMagic); off < size_; ) {
+    Hdr h;
+    std::memcpy(&h, data_ + off, sizeof(h));
+    const std::uint8_t* p = data_ + off + sizeof(h);
+    TraceChunkState st{static_cast<TraceEncoding>(h.encoding), h.pe, p + h.bytes};
+    for (std::uint32_t i = 0; i < h.count; ++i) {
+      decode_trace_event(p, st, ev);
+      f(static_cast<const TraceEvent&>(ev));
+    }
+    off += sizeof(h) + h.bytes;
+  }
+}
+
+} // namespace sim
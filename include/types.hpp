@@ -11,7 +11,9 @@ using Addr  = std::uint64_t;  // dirección en bytes
 using Word  = std::uint64_t;  // dato de 64 bits (puede reinterpretarse como double)
 using PEId  = std::uint32_t;
 
-enum class MESI : std::uint8_t { I, S, E, M };
+// Estados de línea. O (Owned, MOESI) y F (Forward, MESIF) sólo aparecen con
+// esos protocolos; el nombre del enum queda por el protocolo original.
+enum class MESI : std::uint8_t { I, S, E, M, O, F };
 
 enum class BusCmd : std::uint8_t {
   None,
@@ -27,6 +29,7 @@ struct BusRequest {
   Addr         addr{0};
   std::size_t  size{0};   // bytes (normalmente tamaño de línea)
   std::uint64_t tid{0};   // id de transacción (lo asigna el bus)
+  std::uint64_t enq_cycle{0}; // ciclo de bus en que se encoló (lo asigna el bus)
 };
 
 struct BusResponse {
@@ -42,15 +45,18 @@ struct Access {
   AccessType type;
   Addr       addr;
   std::size_t size;
+  std::uint32_t gap = 0;  // ticks de cómputo del PE antes de este acceso
 };
 
 // Helpers para logs
-inline std::string to_string(MESI s) {
+inline const char* to_string(MESI s) {
   switch (s) {
     case MESI::I: return "I";
     case MESI::S: return "S";
     case MESI::E: return "E";
     case MESI::M: return "M";
+    case MESI::O: return "O";
+    case MESI::F: return "F";
   }
   return "?";
 }
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+
+namespace sim::vecops {
+
+// Kernels de las instrucciones vectoriales del Processor (VFMA / VREDUCE).
+// Se resuelven una vez según el CPU del host (AVX > SSE2 > escalar) y dan el
+// mismo resultado bit a bit en todas las variantes:
+// - fma:  acc[i] += a[i] * b[i], producto y suma redondeados por separado
+//         (igual que FMUL + FADD, no es un fma() del host)
+// - hsum: suma horizontal por plegado v[i] += v[i + h], h = n/2, n/4, ..., 1
+//         (n potencia de 2): el orden de las sumas no depende del ancho SIMD
+
+inline constexpr std::size_t kMaxLanes = 16;  // lanes de un registro vectorial (128B)
+
+using FmaFn  = void   (*)(double* acc, const double* a, const double* b, std::size_t n);
+using HsumFn = double (*)(const double* v, std::size_t n);
+
+struct Kernels {
+  FmaFn       fma;
+  HsumFn      hsum;
+  const char* name;  // "avx" | "sse2" | "scalar"
+};
+
+const Kernels& kernels();
+
+} // namespace sim::vecops
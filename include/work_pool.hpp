@@ -0,0 +1,65 @@
+#pragma once
+#include "tick_barrier.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim {
+
+/**
+ * Pool M:N con work stealing para la fase PE de cada tick.
+ *
+ * - Hay W workers (el hilo que llama a run() es el worker 0, se lanzan W-1 hilos).
+ * - run(n, fn) reparte [0, n) en rangos sobre las colas de los workers, abre
+ *   la barrera de inicio y cada worker consume su cola por el frente; cuando
+ *   se vacía, roba rangos del fondo de las colas ajenas.
+ * - run() vuelve sólo cuando TODOS los fn(i) terminaron (barrera de fin), así
+ *   que la fase de bus arranca con todos los PEs del tick ya ejecutados.
+ *
+ * Así el número de PEs simulados no depende de cuántos hilos tiene el host.
+ */
+class WorkStealingPool {
+public:
+  WorkStealingPool(std::size_t workers, std::uint32_t spin_limit);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  // Ejecuta fn(i) para i en [0, n) y bloquea hasta que terminen todos.
+  void run(std::size_t n, const std::function<void(std::size_t)>& fn);
+
+  std::size_t   workers() const { return queues_.size(); }
+  std::uint64_t steals()  const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+  struct Range { std::size_t begin, end; };
+
+  // Cola por worker: el dueño saca del frente, los ladrones del fondo.
+  struct alignas(64) Queue {
+    std::mutex         m;
+    std::vector<Range> items;
+    std::size_t        head = 0;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread>            threads_;
+  SpinParkBarrier start_;   // caller + workers: abre el lote
+  SpinParkBarrier finish_;  // caller + workers: lote completo
+
+  const std::function<void(std::size_t)>* fn_ = nullptr;
+  std::atomic<bool>          halt_{false};
+  std::atomic<std::uint64_t> steals_{0};
+
+  void worker_loop(std::size_t self);
+  void drain(std::size_t self);              // cola propia + robo
+  bool pop_front(std::size_t q, Range& out);
+  bool steal_back(std::size_t q, Range& out);
+};
+
+} // namespace sim
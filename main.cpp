@@ -1,48 +1,101 @@
 #include "simulator.hpp"
+#include "sim_config.hpp"
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
 
 /**
  * Modo normal vs. modo stepping:
  *   - Normal: run_until_done() o demo por defecto
  *   - Stepping: --step | -s para activar; ENTER=step, c=continuar, r=regs, b=bus, q=salir
+ *
+ * Topología y geometría de caché se configuran en runtime (ver SimConfig::usage()).
  */
 int main(int argc, char **argv)
 {
-  sim::Simulator mesi;
+  sim::SimConfig cfg;
+  std::vector<std::string> args;
+  try {
+    args = cfg.parse_args(argc, argv);
+    cfg.validate();
+  } catch (const std::exception& e) {
+    SERR << "[Main] " << e.what() << "\n" << sim::SimConfig::usage();
+    return 1;
+  }
 
   bool stepping = false;
   std::string filePath;
 
-  // Parse simple de argumentos:
+  // Parse simple del resto de argumentos:
   //   --step/-s activa stepping; el primer no-flag es el path del asm
-  for (int i = 1; i < argc; ++i) {
-    std::string a = argv[i];
+  for (const auto& a : args) {
     if (a == "--step" || a == "-s") {
       stepping = true;
+    } else if (a == "--help" || a == "-h") {
+      SOUT << sim::SimConfig::usage();
+      return 0;
     } else {
       filePath = a;
     }
   }
 
-  if (!filePath.empty())
+  // El constructor abre los archivos de --record/--sample: un path inválido
+  // se reporta como el resto de los errores de arranque
+  std::unique_ptr<sim::Simulator> sim_ptr;
+  try {
+    sim_ptr = std::make_unique<sim::Simulator>(cfg);
+  } catch (const std::exception& e) {
+    SERR << "[Main] " << e.what() << "\n";
+    return 1;
+  }
+  sim::Simulator& mesi = *sim_ptr;
+
+  if (!cfg.trace.empty())
+  {
+    // Trace-driven: sin asm ni dot product; corre hasta consumir la traza
+    try {
+      mesi.load_trace_all_from_file(cfg.trace);
+    } catch (const std::exception& e) {
+      SERR << "[Main] " << e.what() << "\n";
+      return 1;
+    }
+  }
+  else if (!filePath.empty())
   {
-    // Precarga datos para N múltiplo de 4 (ej. N=16)
-    mesi.init_dot_problem(/*N=*/16, /*baseA=*/0x000, /*baseB=*/0x100, /*basePS=*/0x200);
+    // Layout de A/B/partial_sums (ver Simulator::dot_layout)
+    const std::size_t N = cfg.dot_n;
+    const auto L = sim::Simulator::dot_layout(cfg);
+    if (L.basePS + cfg.num_pes * 8 > cfg.mem_words * 8)
+      SERR << "[Main] Aviso: el dot product (N=" << N << ") no entra en mem-words="
+           << cfg.mem_words << "; las escrituras fuera de rango se descartan\n";
+
+    try {
+      mesi.init_dot_problem(N, L.baseA, L.baseB, L.basePS);
+    } catch (const std::exception& e) {
+      SERR << "[Main] " << e.what() << "\n";
+      return 1;
+    }
 
     SERR << "[Main] Cargando ASM desde: " << filePath << "\n";
     mesi.load_program_all_from_file(filePath);
-
-    if (stepping) mesi.run_stepping();
-    else          mesi.run_until_done();
   }
   else
   {
     // Demo por defecto
     mesi.load_demo_traces();
+  }
 
-    if (stepping) mesi.run_stepping();
-    else          mesi.run_until_done();
+  // Las salidas (--snapshot, --record, --sample) se cierran al final del run:
+  // un error de escritura llega recién acá
+  try {
+    if (stepping)                mesi.run_stepping();
+    else if (!cfg.trace.empty()) mesi.run_until_done(std::numeric_limits<std::size_t>::max());
+    else                         mesi.run_until_done();
+  } catch (const std::exception& e) {
+    SERR << "[Main] " << e.what() << "\n";
+    return 1;
   }
   return 0;
 }
@@ -0,0 +1,42 @@
+#include "arena.hpp"
+#include <algorithm>
+
+namespace sim
+{
+
+namespace {
+constexpr std::align_val_t kBlockAlign{64};
+}
+
+Arena::Arena(std::size_t block_bytes) : block_bytes_(std::max<std::size_t>(64, block_bytes)) {}
+
+Arena::~Arena() {
+  for (auto& b : blocks_) ::operator delete(b.ptr, kBlockAlign);
+}
+
+void Arena::new_block(std::size_t min_bytes) {
+  // Pedidos más grandes que un bloque se llevan su propio bloque
+  const std::size_t size = std::max(block_bytes_, min_bytes);
+  auto* p = static_cast<std::byte*>(::operator new(size, kBlockAlign));
+  blocks_.push_back({p, size});
+  offset_ = 0;
+  reserved_ += size;
+}
+
+void* Arena::allocate(std::size_t bytes, std::size_t align) {
+  if (bytes == 0) bytes = 1;
+  auto aligned = [&](std::size_t off) { return (off + align - 1) & ~(align - 1); };
+
+  if (blocks_.empty() || aligned(offset_) + bytes > blocks_.back().size)
+    new_block(bytes + align);
+
+  const std::size_t start = aligned(offset_);
+  used_  += start - offset_ + bytes;
+  offset_ = start + bytes;
+
+  std::byte* p = blocks_.back().ptr + start;
+  std::memset(p, 0, bytes);
+  return p;
+}
+
+} // namespace sim
@@ -9,7 +9,8 @@
 namespace sim
 {
 // Ensamblador sencillo: 2 pasadas.
-// 1) Junta labels -> PC. 2) Parsea instrucciones a Program.
+// 1) Junta labels -> PC. 2) Parsea instrucciones a Program (predecodificado:
+//    los JNZ salen con el PC destino ya resuelto).
 
 // --- Tabla global de labels (compartida entre TUs) ---
 static std::unordered_map<std::string, int>& labels_storage() {
@@ -61,6 +62,17 @@ int Assembler::parse_reg(const std::string& token) {
   return idx;
 }
 
+// Acepta "V0..V3"
+int Assembler::parse_vreg(const std::string& token) {
+  if (token.size() < 2 || !(token[0] == 'V' || token[0] == 'v') ||
+      !std::isdigit(static_cast<unsigned char>(token[1])))
+    throw std::runtime_error("Registro vectorial inválido: " + token);
+  int idx = std::stoi(token.substr(1));
+  if (idx < 0 || idx >= kNumVRegs)
+    throw std::runtime_error("Índice fuera de rango (V0..V" + std::to_string(kNumVRegs - 1) + "): " + token);
+  return idx;
+}
+
 // ===== Utilidades locales =====
 
 // Split por espacios/comas, manteniendo "[REGx]" entero
@@ -141,7 +153,41 @@ Program Assembler::assemble_from_string(const std::string& src) {
 
     Instr ins{};
 
-    if (starts_with(tok[0], "LOAD")) {
+    if (starts_with(tok[0], "VLOAD")) {
+      if (tok.size() != 3) throw std::runtime_error("Sintaxis VLOAD: VLOAD Vd, [Rs]");
+      ins.op = OpCode::VLOAD;
+      ins.rd = parse_vreg(tok[1]);
+      ins.ra = parse_reg(tok[2]);
+    }
+    else if (starts_with(tok[0], "VFMA")) {
+      if (tok.size() != 4) throw std::runtime_error("Sintaxis VFMA: VFMA Vd, Va, Vb");
+      ins.op = OpCode::VFMA;
+      ins.rd = parse_vreg(tok[1]);
+      ins.ra = parse_vreg(tok[2]);
+      ins.rb = parse_vreg(tok[3]);
+    }
+    else if (starts_with(tok[0], "VREDUCE")) {
+      if (tok.size() != 3) throw std::runtime_error("Sintaxis VREDUCE: VREDUCE Rd, Va");
+      ins.op = OpCode::VREDUCE;
+      ins.rd = parse_reg(tok[1]);
+      ins.ra = parse_vreg(tok[2]);
+    }
+    else if (starts_with(tok[0], "VZERO")) {
+      if (tok.size() != 2) throw std::runtime_error("Sintaxis VZERO: VZERO Vd");
+      ins.op = OpCode::VZERO;
+      ins.rd = parse_vreg(tok[1]);
+    }
+    else if (starts_with(tok[0], "VINC")) {
+      if (tok.size() != 2) throw std::runtime_error("Sintaxis VINC: VINC Reg");
+      ins.op = OpCode::VINC;
+      ins.rd = parse_reg(tok[1]);
+    }
+    else if (starts_with(tok[0], "VDEC")) {
+      if (tok.size() != 2) throw std::runtime_error("Sintaxis VDEC: VDEC Reg");
+      ins.op = OpCode::VDEC;
+      ins.rd = parse_reg(tok[1]);
+    }
+    else if (starts_with(tok[0], "LOAD")) {
       if (tok.size() != 3) throw std::runtime_error("Sintaxis LOAD: LOAD Rd, [Rs]");
       ins.op = OpCode::LOAD;
       ins.rd = parse_reg(tok[1]);
@@ -203,8 +249,10 @@ Program Assembler::assemble_from_string(const std::string& src) {
     }
     else if (starts_with(tok[0], "JNZ")) {
       if (tok.size() != 2) throw std::runtime_error("Sintaxis JNZ: JNZ label (REG0 implícito)");
-      ins.op   = OpCode::JNZ;
-      ins.label = tok[1]; // PC real se resuelve en ejecución con la tabla de labels
+      ins.op = OpCode::JNZ;
+      auto it = label_to_pc.find(tok[1]);
+      if (it == label_to_pc.end()) throw std::runtime_error("Label no encontrado: " + tok[1]);
+      ins.target = static_cast<std::uint32_t>(it->second);
     }
     else {
       throw std::runtime_error("Instrucción no soportada: " + tok[0]);
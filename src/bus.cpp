@@ -1,76 +1,163 @@
 #include "bus.hpp"
 #include "cache.hpp"
+#include "directory.hpp"
+#include "recorder.hpp"
 #include "config.hpp"
 #include "types.hpp"
 #include <algorithm>
-#include <iomanip>
-#include <sstream>
 
 namespace sim {
 
-Bus::Bus(std::vector<Cache*>& caches) : caches_(caches) {}
+Bus::Bus(std::vector<Cache*>& caches, const SimConfig& cfg)
+    : caches_(caches), line_bytes_(cfg.line_bytes), ops_per_cycle_(cfg.bus_ops_per_cycle),
+      model_(cfg.bus_model), width_(cfg.bus_width), max_outstanding_(cfg.bus_outstanding),
+      lat_flush_(cfg.lat_flush), write_back_(cfg.write_policy == WritePolicy::WriteBack),
+      protocol_(cfg.protocol),
+      parallel_safe_(cfg.num_sets() % std::max<std::size_t>(1, cfg.bus_banks) == 0)
+{
+  const std::size_t nb = std::max<std::size_t>(1, cfg.bus_banks);
+  segs_.reserve(nb);
+  for (std::size_t b = 0; b < nb; ++b) {
+    segs_.push_back(std::make_unique<Segment>());
+    segs_.back()->xfer.resize(line_bytes_);
+  }
+
+  lat_[static_cast<std::size_t>(BusCmd::BusRd)]   = cfg.lat_rd;
+  lat_[static_cast<std::size_t>(BusCmd::BusRdX)]  = cfg.lat_rdx;
+  lat_[static_cast<std::size_t>(BusCmd::BusUpgr)] = cfg.lat_upgr;
+  lat_[static_cast<std::size_t>(BusCmd::Flush)]   = cfg.lat_flush;
+
+  // Con directorio el filtro no aporta: las requests ya van sólo a los sharers
+  if (cfg.snoop_filter && cfg.coherence == CoherenceMode::Snoop)
+    filter_ = std::make_unique<SnoopFilter>(cfg);
+}
 
 void Bus::set_caches(const std::vector<Cache*>& caches) {
-  std::scoped_lock lk(mtx_);
+  // Sólo fuera de la fase bus (construcción / tests)
   caches_ = caches;
 }
 
 void Bus::push_request(const BusRequest& req_in) {
   BusRequest req = req_in;
-  if (req.tid == 0) req.tid = next_tid_++;
-
+  if (req.tid == 0) req.tid = next_tid_.fetch_add(1, std::memory_order_relaxed);
   {
-    std::scoped_lock lk(mtx_);
-    q_.push(req);
+    // Varios PEs empujan a la vez: cada banco tiene su lock
+    Segment& s = *segs_[bank_of(req.addr)];
+    std::scoped_lock lk(s.mtx);
+    req.enq_cycle = s.cycle;
+    s.q.push(req);
+    s.stats.max_depth = std::max(s.stats.max_depth, s.q.size());
   }
-  Addr line_base = (req.addr / cfg::kLineBytes) * cfg::kLineBytes;
-  LOG_IF(cfg::kLogBus, "[BUS] push T#" << req.tid
-        << " src=PE" << req.source
-        << " " << cmd_str(req.cmd)
-        << " line=0x" << std::hex << line_base << std::dec
-        << " size=" << req.size);
+  Addr line_base = (req.addr / line_bytes_) * line_bytes_;
+  LOGF(cfg::kLogBus, "[BUS] push T#{} src=PE{} {} line=0x{x} size={}",
+       req.tid, req.source, cmd_str(req.cmd), line_base, req.size);
 }
 
-void Bus::broadcast(const BusRequest& req) {
-  Addr line_base = (req.addr / cfg::kLineBytes) * cfg::kLineBytes;
-  LOG_IF(cfg::kLogBus, "[BUS] proc T#" << req.tid
-        << " PE" << req.source
-        << " " << cmd_str(req.cmd)
-        << " line=0x" << std::hex << line_base << std::dec);
+Bus::Outcome Bus::broadcast(Segment& s, const BusRequest& req) {
+  Addr line_base = (req.addr / line_bytes_) * line_bytes_;
+  LOGF(cfg::kLogBus, "[BUS] proc T#{} PE{} {} line=0x{x}",
+       req.tid, req.source, cmd_str(req.cmd), line_base);
 
   // Contar comando
-  cmd_counts_[static_cast<std::size_t>(req.cmd)]++;
+  s.cmd_counts[static_cast<std::size_t>(req.cmd)]++;
+  s.stats.requests++;
 
   // Recorremos cachés (snoop). Si alguna devuelve datos (Flush), lo registramos.
   std::optional<Word> data_from_peer;
-  std::vector<int> acted_pes;
+  // PEs que reaccionaron: sólo el conteo y, para el log, la máscara de los 64 primeros
+  std::uint64_t acted = 0, acted_mask = 0;
   int provider_id = -1; // PE que proveyó datos (Flush), si aplica
+  LineXfer xfer{s.xfer.data(), false};
 
-  for (auto* c : caches_) {
-    if (!c) continue;
-    if (c->owner() == req.source) continue; // evitar self-snoop
-
+  auto snoop_one = [&](Cache* c) {
     std::optional<Word> local;
-    bool acted = c->snoop(req, local);
-    if (acted) acted_pes.push_back(static_cast<int>(c->owner()));
+    ++s.snoops;
+    if (c->snoop(req, local, &xfer)) {
+      ++acted;
+      if (c->owner() < 64) acted_mask |= std::uint64_t{1} << c->owner();
+    }
     if (local.has_value() && provider_id < 0) {
-      data_from_peer = local; 
+      data_from_peer = local;
       provider_id = static_cast<int>(c->owner());
     }
+  };
+
+  // Write-back: el emisor instala la línea con los snoops ya resueltos (y antes
+  // de actualizar directorio/filtro, que así lo ven como sharer)
+  bool shared = false;  // alguna otra caché tiene la línea
+  auto grant = [&] {
+    if (write_back_ && req.source < caches_.size() && caches_[req.source])
+      caches_[req.source]->bus_grant(req, shared, xfer.filled ? xfer.data : nullptr);
+  };
+
+  if (dir_) {
+    // Directorio (caches_ está indexado por PE): BusRdX/BusUpgr invalidan a
+    // todos los sharers; con write-back un BusRd va sólo al owner (si no hay,
+    // provee la memoria). Con write-through las cachés cambian de estado en la
+    // fase PE, antes de que el bus ordene la request: puede haber más de una
+    // copia en E/M a la vez y el BusRd sigue yendo a todos los sharers.
+    const SharerMap::Line line = dir_->lookup(line_base);
+    SharerSet others = line.sharers;
+    if (req.source < caches_.size()) others.reset(req.source);
+    shared = !others.none();
+
+    std::uint64_t forwards = 0;
+    auto forward = [&](PEId pe) {
+      if (pe == req.source || pe >= caches_.size() || !caches_[pe]) return;
+      ++forwards;
+      snoop_one(caches_[pe]);
+    };
+    const bool to_owner = req.cmd == BusCmd::BusRd && write_back_;
+    if (!to_owner)            others.for_each(forward);
+    else if (line.owner >= 0) forward(static_cast<PEId>(line.owner));
+    // req -> home, home -> owner/sharer (forward/inval), respuesta -> home, home -> grant
+    s.p2p_msgs += 2 + 2 * forwards;
+    grant();
+
+    if (req.cmd == BusCmd::BusRdX || req.cmd == BusCmd::BusUpgr) {
+      dir_->grant_exclusive(line_base, req.source); // el resto quedó invalidado
+    } else if (to_owner) {
+      // Tras el BusRd: sin otros sharers el que pide queda en E; en MESIF queda
+      // en F (el último en leer reenvía); en MOESI el owner sigue como O si dio
+      // los datos (estaba en M/O); si no, el owner (E/M) bajó a S
+      int owner = -1;
+      if (!shared || protocol_ == Protocol::MESIF)
+        owner = static_cast<int>(req.source);
+      else if (protocol_ == Protocol::MOESI && line.owner >= 0 && data_from_peer.has_value())
+        owner = line.owner;
+      dir_->set_owner(line_base, owner);
+    }
+  } else if (filter_) {
+    // Broadcast filtrado: sólo a quienes pueden tener la línea
+    filter_->lookup(line_base, req.source).for_each([&](PEId pe) {
+      if (pe < caches_.size() && caches_[pe]) snoop_one(caches_[pe]);
+    });
+    shared = acted != 0;
+    grant();
+    if (req.cmd == BusCmd::BusRdX || req.cmd == BusCmd::BusUpgr)
+      filter_->keep_only(line_base, req.source);
+  } else {
+    for (auto* c : caches_) {
+      if (!c) continue;
+      if (c->owner() == req.source) continue; // evitar self-snoop
+      snoop_one(c);
+    }
+    shared = acted != 0;
+    grant();
   }
 
   // Contabilización de tráfico en el bus:
   std::uint64_t add_bytes = 0;
   if (data_from_peer.has_value()) {
     // Intervención: transferencia de una línea completa
-    add_bytes = cfg::kLineBytes;
-    bus_bytes_ += add_bytes;
-    flushes_++;
+    add_bytes = line_bytes_;
+    s.flushes++;
   } else {
     // Tráfico reportado por la petición (p.e. Upgr sin datos)
     add_bytes = req.size;
-    bus_bytes_ += add_bytes;
   }
+  s.bus_bytes   += add_bytes;
+  s.stats.bytes += add_bytes;
 
   // --- NUEVO: Acreditar tráfico por-PE ---
   // 1) Al emisor de la transacción
@@ -86,61 +173,182 @@ void Bus::broadcast(const BusRequest& req) {
     for (auto* c : caches_) {
       if (!c) continue;
       if (static_cast<int>(c->owner()) == provider_id) {
-        c->account_bus_bytes(cfg::kLineBytes); // el que flushea también participa
+        c->account_bus_bytes(line_bytes_); // el que flushea también participa
         break;
       }
     }
   }
 
-  // Resumen de snoops
-  std::ostringstream oss;
-  if (acted_pes.empty()) {
-    oss << "none";
-  } else {
-    for (std::size_t i = 0; i < acted_pes.size(); ++i) {
-      if (i) oss << ",";
-      oss << "PE" << acted_pes[i];
+  // Resumen de snoops (se formatea en el drenador del log, no acá)
+  LOGF(cfg::kLogBus, "[BUS] T#{} snoops: {pes} | bytes+={} | total={} | flushes={}",
+       req.tid, acted_mask, acted - static_cast<std::uint64_t>(__builtin_popcountll(acted_mask)),
+       add_bytes, s.bus_bytes, s.flushes);
+
+  if (rec_) rec_->bus(bank_of(req.addr), req, shared, data_from_peer.has_value() || xfer.filled);
+
+  return {add_bytes, data_from_peer.has_value()};
+}
+
+void Bus::step() {
+  for (std::size_t b = 0; b < segs_.size(); ++b) step_bank(b);
+}
+
+void Bus::step_bank(std::size_t b) {
+  Segment& s = *segs_[b];
+  ++s.cycle;
+  if (model_ == BusModel::Split) step_split(s);
+  else                           step_atomic(s);
+}
+
+void Bus::step_atomic(Segment& s) {
+  std::size_t processed = 0;
+  while (processed < ops_per_cycle_) {
+    BusRequest req;
+    {
+      std::scoped_lock lk(s.mtx);
+      if (s.q.empty()) {
+        if (!s.was_empty) {
+          LOGF(cfg::kLogBus, "[BUS] step: cola vacía");
+          s.was_empty = true;
+        }
+        break;
+      }
+      req = s.q.front(); s.q.pop();
     }
+    s.was_empty = false;
+    broadcast(s, req);
+    if (write_back_) caches_[req.source]->bus_done(req);
+    processed++;
   }
+  if (processed) s.stats.busy_cycles++;
+}
 
-  LOG_IF(cfg::kLogBus, "[BUS] T#" << req.tid
-        << " snoops:" << (acted_pes.empty() ? " none" : (" " + oss.str()))
-        << " | bytes+=" << add_bytes
-        << " | total=" << bus_bytes_
-        << " | flushes=" << flushes_);
+void Bus::note_fill(PEId pe, Addr line_addr) {
+  if (dir_)    dir_->add_sharer(line_addr, pe);
+  if (filter_) filter_->on_fill(line_addr, pe);
 }
 
-void Bus::step() {
+void Bus::note_evict(PEId pe, Addr line_addr) {
+  if (dir_)    dir_->remove_sharer(line_addr, pe);
+  if (filter_) filter_->on_evict(line_addr, pe);
+}
+
+std::uint64_t Bus::p2p_msgs() const {
+  // Las evicciones también viajan al home como mensaje (PutS/PutM)
+  std::uint64_t n = dir_ ? dir_->evict_notices() : 0;
+  for (const auto& s : segs_) n += s->p2p_msgs;
+  return n;
+}
+
+std::size_t Bus::pending() const {
+  std::size_t n = 0;
+  for (const auto& s : segs_) {
+    std::scoped_lock lk(s->mtx);
+    n += s->q.size() + s->inflight.size();
+  }
+  return n;
+}
+
+void Bus::step_split(Segment& s) {
+  // 1) Fase de datos: width_ bytes por ciclo, a las transacciones cuya latencia
+  //    ya pasó, en orden de emisión (las que aún esperan no frenan a las demás)
+  std::uint64_t budget = width_;
+  bool busy = false;
+  for (auto it = s.inflight.begin(); it != s.inflight.end(); ) {
+    if (it->ready > s.cycle) { ++it; continue; }
+    if (it->bytes_left > 0) {
+      if (budget == 0) break;
+      const std::uint64_t take = std::min<std::uint64_t>(budget, it->bytes_left);
+      it->bytes_left -= take;
+      budget -= take;
+      busy = true;
+    }
+    if (it->bytes_left > 0) { ++it; continue; }
+
+    const std::uint64_t lat = s.cycle - it->req.enq_cycle;
+    s.split.completed++;
+    s.split.latency_sum += lat;
+    s.split.latency_max = std::max(s.split.latency_max, lat);
+    LOGF(cfg::kLogBus, "[BUS] done T#{} {} lat={} (cola={})",
+         it->req.tid, cmd_str(it->req.cmd), lat, it->addr_cycle - it->req.enq_cycle);
+    if (write_back_) caches_[it->req.source]->bus_done(it->req);
+    it = s.inflight.erase(it);
+  }
+  if (busy) s.split.data_busy_cycles++;
+
+  // 2) Fase de dirección: snoop (punto de orden de la coherencia) y a vuelo
   std::size_t processed = 0;
-  while (processed < cfg::kBusOpsPerCycle) {
+  while (processed < ops_per_cycle_) {
     BusRequest req;
     {
-      std::scoped_lock lk(mtx_);
-      if (q_.empty()) {
-        if (!bus_was_empty_) {
-          LOG_IF(cfg::kLogBus, "[BUS] step: cola vacía");
-          bus_was_empty_ = true;
+      std::scoped_lock lk(s.mtx);
+      if (s.q.empty()) {
+        if (!s.was_empty && s.inflight.empty()) {
+          LOGF(cfg::kLogBus, "[BUS] step: cola vacía");
+          s.was_empty = true;
         }
         break;
       }
-      req = q_.front(); q_.pop();
+      if (s.inflight.size() >= max_outstanding_) { s.split.addr_stalls++; break; }
+      req = s.q.front(); s.q.pop();
     }
-    bus_was_empty_ = false;
-    broadcast(req);
+    s.was_empty = false;
+
+    const Outcome out = broadcast(s, req);
+    const std::uint64_t lat = out.from_peer && req.cmd != BusCmd::BusUpgr
+                                ? lat_flush_
+                                : lat_[static_cast<std::size_t>(req.cmd)];
+    s.inflight.push_back({req, s.cycle + lat, out.bytes, s.cycle});
+
+    const std::uint64_t qd = s.cycle - req.enq_cycle;
+    s.split.queue_delay_sum += qd;
+    s.split.queue_delay_max = std::max(s.split.queue_delay_max, qd);
     processed++;
   }
+  if (busy || processed) s.stats.busy_cycles++;
+}
+
+Bus::SplitStats Bus::split_stats() const {
+  SplitStats t;
+  for (const auto& seg : segs_) {
+    const auto& st = seg->split;
+    t.completed        += st.completed;
+    t.queue_delay_sum  += st.queue_delay_sum;
+    t.queue_delay_max   = std::max(t.queue_delay_max, st.queue_delay_max);
+    t.latency_sum      += st.latency_sum;
+    t.latency_max       = std::max(t.latency_max, st.latency_max);
+    t.data_busy_cycles += st.data_busy_cycles;
+    t.addr_stalls      += st.addr_stalls;
+  }
+  return t;
+}
+
+Bus::BankStats Bus::bank_stats(std::size_t b) const {
+  return segs_[b]->stats;
 }
 
 std::uint64_t Bus::bytes() const {
-  return bus_bytes_;
+  std::uint64_t n = 0;
+  for (const auto& s : segs_) n += s->bus_bytes;
+  return n;
 }
 
 std::uint64_t Bus::count_cmd(BusCmd cmd) const {
-  return cmd_counts_[static_cast<std::size_t>(cmd)];
+  std::uint64_t n = 0;
+  for (const auto& s : segs_) n += s->cmd_counts[static_cast<std::size_t>(cmd)];
+  return n;
 }
 
 std::uint64_t Bus::flushes() const {
-  return flushes_;
+  std::uint64_t n = 0;
+  for (const auto& s : segs_) n += s->flushes;
+  return n;
+}
+
+std::uint64_t Bus::snoops() const {
+  std::uint64_t n = 0;
+  for (const auto& s : segs_) n += s->snoops;
+  return n;
 }
 
 } // namespace sim
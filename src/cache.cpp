@@ -2,6 +2,7 @@
 #include "bus.hpp"
 #include "memory.hpp"
 #include "config.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iomanip>
@@ -10,15 +11,24 @@
 namespace sim
 {
 
-  Cache::Cache(PEId owner, Bus &bus, Memory &mem)
-      : pe_(owner), bus_(bus), mem_(mem)
+  Cache::Cache(PEId owner, Bus &bus, Memory &mem, const SimConfig &cfg, Arena &arena)
+      : pe_(owner), bus_(bus), mem_(mem),
+        line_bytes_(cfg.line_bytes), num_lines_(cfg.cache_lines),
+        ways_(cfg.cache_ways), num_sets_(cfg.num_sets()),
+        find_fn_(tagmatch::function(tagmatch::resolve(cfg.tag_match))),
+        repl_(cfg.repl, num_sets_, ways_, arena, owner + 1),
+        write_back_(cfg.write_policy == WritePolicy::WriteBack),
+        protocol_(cfg.protocol)
   {
-    // Inicializa sets y ways con líneas vacías
-    sets_.resize(num_sets_);
-    for (auto &set : sets_)
-    {
-      set.ways = std::vector<CacheLine>(cfg::kCacheWays, CacheLine(line_bytes_));
-    }
+    // Todas las líneas vacías: la arena entrega memoria en cero (inválida, limpia)
+    tags_   = arena.make_array<std::uint64_t>(num_lines_);
+    states_ = arena.make_array<MESI>(num_lines_);
+    valid_  = arena.make_array<std::uint8_t>(num_lines_);
+    dirty_  = arena.make_array<std::uint8_t>(num_lines_);
+    data_   = arena.make_array<std::uint8_t>(num_lines_ * line_bytes_);
+    pending_buf_ = arena.make_array<std::uint8_t>(line_bytes_);
+    std::fill_n(states_, num_lines_, MESI::I);
+    std::fill_n(tags_, num_lines_, tagmatch::kNoTag);
   }
 
   std::pair<std::size_t, std::uint64_t> Cache::index_tag(Addr addr) const
@@ -31,118 +41,167 @@ namespace sim
 
   int Cache::find_way(std::size_t set_idx, std::uint64_t tag) const
   {
-    const auto &set = sets_[set_idx];
-    for (int w = 0; w < static_cast<int>(set.ways.size()); ++w)
-    {
-      if (set.ways[w].valid && set.ways[w].tag == tag)
-        return w;
-    }
-    return -1;
+    // Las ways inválidas tienen tag kNoTag: basta comparar tags
+    const std::uint64_t *tags = tags_ + set_idx * ways_;
+    if (ways_ < kSimdMinWays)
+      return tagmatch::find_scalar(tags, ways_, tag);
+    return find_fn_(tags, ways_, tag);
   }
 
-  int Cache::select_victim(std::size_t set_idx) const
+  int Cache::select_victim(std::size_t set_idx)
   {
-    const auto &set = sets_[set_idx];
-    for (int w = 0; w < static_cast<int>(set.ways.size()); ++w)
+    const std::size_t base = set_idx * ways_;
+    for (std::size_t w = 0; w < ways_; ++w)
     {
-      if (!set.ways[w].valid)
-        return w;
+      if (!valid_[base + w])
+      {
+        metrics_.repl_invalid_fills++;
+        return static_cast<int>(w);
+      }
     }
-    return 0; // FIFO simplificado
+    metrics_.repl_evictions++;
+    return static_cast<int>(repl_.victim(set_idx));
+  }
+
+  // Línea completa <-> DRAM: un memcpy bajo el lock de la stripe de la línea
+  void Cache::write_line_to_mem(std::size_t sl, Addr base)
+  {
+    mem_.write_line(base, line_data(sl));
+  }
+
+  void Cache::read_line_from_mem(std::size_t sl, Addr base)
+  {
+    mem_.read_line(base, line_data(sl));
   }
 
-  bool Cache::read_hit(std::size_t set_idx, int way, Addr addr, std::size_t size, Word &out)
+  bool Cache::read_hit(std::size_t set_idx, int way, Addr addr, std::size_t size, void *out)
   {
-    auto &line = sets_[set_idx].ways[way];
-    if (!line.valid || line.state == MESI::I)
+    const std::size_t sl = slot(set_idx, way);
+    if (!valid_[sl] || states_[sl] == MESI::I)
       return false;
 
     const std::size_t off = line_offset(addr);
     assert(off + size <= line_bytes_ && "Lectura cruza límite de línea");
-    std::memcpy(&out, line.data.data() + off, size);
+    std::memcpy(out, line_data(sl) + off, size);
+    repl_.on_hit(set_idx, static_cast<std::size_t>(way));
 
     metrics_.hits++;
     metrics_.loads++;
-    LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_ << "] READ HIT set=" << set_idx
-                                       << " way=" << way << " state=" << to_string(line.state));
+    LOGF(cfg::kLogCache, "[CACHE PE{}] READ HIT set={} way={} state={}",
+         pe_, set_idx, way, to_string(states_[sl]));
     return true;
   }
 
   bool Cache::write_hit(std::size_t set_idx, int way, Addr addr, std::size_t size, Word value)
   {
-    auto &line = sets_[set_idx].ways[way];
-    if (!line.valid || line.state == MESI::I)
+    const std::size_t sl = slot(set_idx, way);
+    if (!valid_[sl] || states_[sl] == MESI::I)
       return false;
 
+    const std::size_t off = line_offset(addr);
+    assert(off + size <= line_bytes_ && "Escritura cruza límite de línea");
+
+    if (write_back_)
+    {
+      if (states_[sl] == MESI::S || states_[sl] == MESI::O || states_[sl] == MESI::F)
+      {
+        // {S,O,F}->M necesita invalidar a los demás: la escritura se hace en el grant
+        LOGF(cfg::kLogCache, "[CACHE PE{}] WRITE HIT necesita BusUpgr en addr=0x{x} (state={}, espera al bus)",
+             pe_, addr, to_string(states_[sl]));
+        bus_.push_request(BusRequest{BusCmd::BusUpgr, pe_, addr, line_bytes_});
+        pending_ = {true, false, true, BusCmd::BusUpgr, addr, size, value,
+                    line_base(addr), set_idx, way};
+        metrics_.trans_s_to_m++;
+        metrics_.hits++;
+        metrics_.stores++;
+        return true;
+      }
+      if (states_[sl] == MESI::E)
+      {
+        states_[sl] = MESI::M;  // E->M silencioso: nadie más la tiene
+        metrics_.trans_e_to_m++;
+      }
+      std::memcpy(line_data(sl) + off, &value, size);
+      dirty_[sl] = true;
+      repl_.on_hit(set_idx, static_cast<std::size_t>(way));
+
+      metrics_.hits++;
+      metrics_.stores++;
+      LOGF(cfg::kLogCache, "[CACHE PE{}] WRITE HIT set={} way={} -> state=M dirty=1 (write-back)",
+           pe_, set_idx, way);
+      return true;
+    }
+
     // Si estaba S/E, necesitamos upgrade de permisos a M antes de escribir
-    if (line.state == MESI::S || line.state == MESI::E)
+    if (states_[sl] == MESI::S || states_[sl] == MESI::E)
     {
-      LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_
-             << "] WRITE HIT necesita BusUpgr en addr=0x" << std::hex << addr << std::dec
-             << " (state=" << to_string(line.state) << ")");
+      LOGF(cfg::kLogCache, "[CACHE PE{}] WRITE HIT necesita BusUpgr en addr=0x{x} (state={})",
+           pe_, addr, to_string(states_[sl]));
       BusRequest up{BusCmd::BusUpgr, pe_, addr, line_bytes_};
       bus_.push_request(up);
 
       // ---- Contabilizamos transiciones ----
-      if (line.state == MESI::S) metrics_.trans_s_to_m++;
-      else if (line.state == MESI::E) metrics_.trans_e_to_m++;
+      if (states_[sl] == MESI::S) metrics_.trans_s_to_m++;
+      else if (states_[sl] == MESI::E) metrics_.trans_e_to_m++;
 
-      line.state = MESI::M;
+      states_[sl] = MESI::M;
     }
 
     // Escritura local + write-through a DRAM
-    const std::size_t off = line_offset(addr);
-    assert(off + size <= line_bytes_ && "Escritura cruza límite de línea");
-    std::memcpy(line.data.data() + off, &value, size);
+    std::memcpy(line_data(sl) + off, &value, size);
     mem_.write64(addr, value); // write-through
-    line.dirty = false;        // mantenemos limpia
+    dirty_[sl] = false;        // mantenemos limpia
+    repl_.on_hit(set_idx, static_cast<std::size_t>(way));
 
     metrics_.hits++;
     metrics_.stores++;
-    LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_
-           << "] WRITE HIT set=" << set_idx << " way=" << way
-           << " -> state=" << to_string(line.state) << " dirty=0 (write-through)");
+    metrics_.dram_write_bytes += size;
+    LOGF(cfg::kLogCache, "[CACHE PE{}] WRITE HIT set={} way={} -> state={} dirty=0 (write-through)",
+         pe_, set_idx, way, to_string(states_[sl]));
     return true;
   }
 
-  bool Cache::handle_load_miss(Addr addr, std::size_t size, Word &out)
+  bool Cache::handle_load_miss(Addr addr, std::size_t size, void *out)
   {
+    if (write_back_)
+      return begin_miss(addr, size, BusCmd::BusRd, 0);
+
     auto [set_idx, tag] = index_tag(addr);
     int victim = select_victim(set_idx);
-    auto &line = sets_[set_idx].ways[victim];
+    const std::size_t sl = slot(set_idx, victim);
 
     // Write-back si se evicta una M sucia (en este diseño intentamos mantener líneas limpias)
-    if (line.valid && line.dirty)
+    if (valid_[sl] && dirty_[sl])
     {
-      Addr victim_addr = ((line.tag * num_sets_) + set_idx) * line_bytes_;
-      for (std::size_t off = 0; off < line_bytes_; off += sizeof(Word)) {
-        Word w;
-        std::memcpy(&w, line.data.data() + off, sizeof(Word));
-        mem_.write64(victim_addr + off, w);
-      }
-      line.dirty = false;
-      LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_ << "] WB (LOAD miss) addr=0x"
-                                         << std::hex << victim_addr << std::dec);
+      Addr victim_addr = slot_addr(set_idx, sl);
+      write_line_to_mem(sl, victim_addr);
+      dirty_[sl] = false;
+      metrics_.writebacks++;
+      metrics_.dram_write_bytes += line_bytes_;
+      LOGF(cfg::kLogCache, "[CACHE PE{}] WB (LOAD miss) addr=0x{x}", pe_, victim_addr);
     }
 
-    LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_ << "] LOAD MISS addr=0x"
-                                       << std::hex << addr << std::dec << " -> BusRd");
+    // La víctima deja la caché: avisar al directorio/snoop filter (si hay)
+    if (valid_[sl])
+      bus_.note_evict(pe_, slot_addr(set_idx, sl));
+
+    LOGF(cfg::kLogCache, "[CACHE PE{}] LOAD MISS addr=0x{x} -> BusRd", pe_, addr);
     BusRequest req{BusCmd::BusRd, pe_, addr, line_bytes_};
     bus_.push_request(req);
 
     // Traemos línea completa desde DRAM
     Addr base = line_base(addr);
-    for (std::size_t off = 0; off < line_bytes_; off += sizeof(Word)) {
-      Word w = mem_.read64(base + off);
-      std::memcpy(line.data.data() + off, &w, sizeof(Word));
-    }
+    read_line_from_mem(sl, base);
+    metrics_.dram_read_bytes += line_bytes_;
 
-    line.valid = true;
-    line.tag   = tag;
-    line.state = MESI::E; // E si nadie intervino; si alguien la tenía, el snoop la degradará a S
+    valid_[sl]  = true;
+    tags_[sl]   = tag;
+    states_[sl] = MESI::E; // E si nadie intervino; si alguien la tenía, el snoop la degradará a S
+    repl_.on_fill(set_idx, static_cast<std::size_t>(victim));
+    bus_.note_fill(pe_, base);
 
     const std::size_t off = line_offset(addr);
-    std::memcpy(&out, line.data.data() + off, size);
+    std::memcpy(out, line_data(sl) + off, size);
 
     metrics_.misses++;
     metrics_.loads++;
@@ -151,60 +210,198 @@ namespace sim
 
   bool Cache::handle_store_miss(Addr addr, std::size_t size, Word value)
   {
+    if (write_back_)
+      return begin_miss(addr, size, BusCmd::BusRdX, value);
+
     auto [set_idx, tag] = index_tag(addr);
     int victim = select_victim(set_idx);
-    auto &line = sets_[set_idx].ways[victim];
+    const std::size_t sl = slot(set_idx, victim);
 
     // Write-back si se evicta una M sucia (poco frecuente con write-through)
-    if (line.valid && line.dirty)
+    if (valid_[sl] && dirty_[sl])
     {
-      Addr victim_addr = ((line.tag * num_sets_) + set_idx) * line_bytes_;
-      for (std::size_t off = 0; off < line_bytes_; off += sizeof(Word)) {
-        Word w;
-        std::memcpy(&w, line.data.data() + off, sizeof(Word));
-        mem_.write64(victim_addr + off, w);
-      }
-      line.dirty = false;
-      LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_ << "] WB (STORE miss) addr=0x"
-                                         << std::hex << victim_addr << std::dec);
+      Addr victim_addr = slot_addr(set_idx, sl);
+      write_line_to_mem(sl, victim_addr);
+      dirty_[sl] = false;
+      metrics_.writebacks++;
+      metrics_.dram_write_bytes += line_bytes_;
+      LOGF(cfg::kLogCache, "[CACHE PE{}] WB (STORE miss) addr=0x{x}", pe_, victim_addr);
     }
 
+    // La víctima deja la caché: avisar al directorio/snoop filter (si hay)
+    if (valid_[sl])
+      bus_.note_evict(pe_, slot_addr(set_idx, sl));
+
     // Write-allocate con intención de escribir: usamos BusRdX para tomar exclusión
-    LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_ << "] STORE MISS addr=0x"
-                                       << std::hex << addr << std::dec << " -> BusRdX");
+    LOGF(cfg::kLogCache, "[CACHE PE{}] STORE MISS addr=0x{x} -> BusRdX", pe_, addr);
     BusRequest req{BusCmd::BusRdX, pe_, addr, line_bytes_};
     bus_.push_request(req);
 
     // Traemos línea completa desde DRAM
     Addr base = line_base(addr);
-    for (std::size_t off = 0; off < line_bytes_; off += sizeof(Word)) {
-      Word w = mem_.read64(base + off);
-      std::memcpy(line.data.data() + off, &w, sizeof(Word));
-    }
+    read_line_from_mem(sl, base);
+    metrics_.dram_read_bytes += line_bytes_;
 
     // Escribimos el valor y hacemos write-through
     const std::size_t off = line_offset(addr);
     assert(off + size <= line_bytes_);
-    std::memcpy(line.data.data() + off, &value, size);
+    std::memcpy(line_data(sl) + off, &value, size);
     mem_.write64(addr, value);
+    metrics_.dram_write_bytes += size;
 
-    line.valid = true;
-    line.tag   = tag;
-    line.state = MESI::M;   // exclusivo modificado (pero limpio por WT)
-    line.dirty = false;
+    valid_[sl]  = true;
+    tags_[sl]   = tag;
+    states_[sl] = MESI::M;   // exclusivo modificado (pero limpio por WT)
+    dirty_[sl]  = false;
+    repl_.on_fill(set_idx, static_cast<std::size_t>(victim));
+    bus_.note_fill(pe_, base);
 
     metrics_.misses++;
     metrics_.stores++;
     return true;
   }
 
+  // ------------------ Write-back: misses pendientes ------------------
+  bool Cache::begin_miss(Addr addr, std::size_t size, BusCmd cmd, Word value)
+  {
+    auto [set_idx, tag] = index_tag(addr);
+    const int victim = select_victim(set_idx);
+    const std::size_t sl = slot(set_idx, victim);
+
+    if (valid_[sl])
+    {
+      const Addr victim_addr = slot_addr(set_idx, sl);
+      if (dirty_[sl])
+      {
+        write_line_to_mem(sl, victim_addr);
+        metrics_.writebacks++;
+        metrics_.dram_write_bytes += line_bytes_;
+        LOGF(cfg::kLogCache, "[CACHE PE{}] WB (evict) addr=0x{x}", pe_, victim_addr);
+      }
+      bus_.note_evict(pe_, victim_addr);
+
+      // La way queda reservada (inválida) hasta que el bus conceda la línea
+      valid_[sl]  = false;
+      dirty_[sl]  = false;
+      states_[sl] = MESI::I;
+      tags_[sl]   = tagmatch::kNoTag;
+    }
+
+    LOGF(cfg::kLogCache, "[CACHE PE{}] {} MISS addr=0x{x} -> {} (espera al bus)",
+         pe_, cmd == BusCmd::BusRd ? "LOAD" : "STORE", addr, cmd_str(cmd));
+    bus_.push_request(BusRequest{cmd, pe_, addr, line_bytes_});
+    pending_ = {true, false, cmd != BusCmd::BusRd, cmd, addr, size, value,
+                line_base(addr), set_idx, victim};
+
+    metrics_.misses++;
+    if (cmd == BusCmd::BusRd) metrics_.loads++;
+    else                      metrics_.stores++;
+    return false;
+  }
+
+  bool Cache::resume_pending(Addr addr, void *out)
+  {
+    if (!pending_.done || addr != pending_.addr)
+    {
+      metrics_.stall_cycles++;
+      return false;
+    }
+    if (!pending_.store)
+      std::memcpy(out, pending_buf_, pending_.size);
+    pending_ = {};
+    return true;
+  }
+
+  void Cache::bus_grant(const BusRequest &req, bool shared, const std::uint8_t *c2c)
+  {
+    if (!pending_.active || pending_.done || line_base(req.addr) != pending_.line)
+      return;
+
+    auto [set_idx, tag] = index_tag(req.addr);
+    const std::size_t sl = slot(pending_.set, pending_.way);
+    if (!valid_[sl] || tags_[sl] != tag)
+    {
+      // Miss (o un Upgr que perdió la línea por el camino): la línea viene de
+      // otra caché (MOESI/MESIF) o de DRAM, ya al día por los Flush de los snoops
+      if (c2c)
+      {
+        std::memcpy(line_data(sl), c2c, line_bytes_);
+        bump(metrics_.c2c_fills);
+      }
+      else
+      {
+        read_line_from_mem(sl, pending_.line);
+        bump(metrics_.dram_read_bytes, line_bytes_);
+      }
+      valid_[sl] = true;
+      tags_[sl]  = tag;
+      dirty_[sl] = false;
+      // Fase bus: sin carrera con el PE (barrera) ni con otro banco (un solo pending_)
+      repl_.on_fill(set_idx, static_cast<std::size_t>(pending_.way));
+      bus_.note_fill(pe_, pending_.line);
+    }
+    if (req.cmd != BusCmd::BusRd)
+      states_[sl] = MESI::M;
+    else if (!shared)
+      states_[sl] = MESI::E;
+    else
+      states_[sl] = protocol_ == Protocol::MESIF ? MESI::F : MESI::S;  // MESIF: el último en leer reenvía
+
+    // El acceso se completa acá: lo que pase con la línea después ya es posterior
+    const std::size_t off = line_offset(pending_.addr);
+    if (pending_.store)
+    {
+      std::memcpy(line_data(sl) + off, &pending_.value, pending_.size);
+      dirty_[sl] = true;
+    }
+    else
+    {
+      std::memcpy(pending_buf_, line_data(sl) + off, pending_.size);
+    }
+    LOGF(cfg::kLogCache, "[CACHE PE{}] GRANT {} line=0x{x} -> {}",
+         pe_, cmd_str(req.cmd), pending_.line, to_string(states_[sl]));
+  }
+
+  void Cache::bus_done(const BusRequest &req)
+  {
+    if (pending_.active && pending_.cmd == req.cmd && line_base(req.addr) == pending_.line)
+      pending_.done = true;
+  }
+
+  void Cache::write_back_all()
+  {
+    for (std::size_t s = 0; s < num_sets_; ++s)
+    {
+      for (std::size_t w = 0; w < ways_; ++w)
+      {
+        const std::size_t sl = slot(s, static_cast<int>(w));
+        if (valid_[sl] && dirty_[sl])
+        {
+          write_line_to_mem(sl, slot_addr(s, sl));
+          dirty_[sl] = false;
+        }
+      }
+    }
+  }
+
   bool Cache::load(Addr addr, std::size_t size, Word &out)
   {
+    return load_block(addr, size, &out);
+  }
+
+  bool Cache::load_block(Addr addr, std::size_t size, void *out)
+  {
+    // Write-back: reintento de un miss que esperaba al bus (ya contado al emitirlo)
+    if (pending_.active)
+    {
+      resume_pending(addr, out);
+      return false;
+    }
+
     auto [set_idx, tag] = index_tag(addr);
     int way = find_way(set_idx, tag);
-    LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_ << "] LOAD addr=0x"
-                                       << std::hex << addr << std::dec << " set=" << set_idx
-                                       << " tag=" << tag << (way >= 0 ? " (hit)" : " (miss)"));
+    LOGF(cfg::kLogCache, "[CACHE PE{}] LOAD addr=0x{x} set={} tag={}{}",
+         pe_, addr, set_idx, tag, way >= 0 ? " (hit)" : " (miss)");
     if (way >= 0)
       return read_hit(set_idx, way, addr, size, out);
     return handle_load_miss(addr, size, out);
@@ -212,17 +409,23 @@ namespace sim
 
   bool Cache::store(Addr addr, std::size_t size, Word value)
   {
+    if (pending_.active)
+    {
+      Word unused = 0;
+      resume_pending(addr, &unused);
+      return false;
+    }
+
     auto [set_idx, tag] = index_tag(addr);
     int way = find_way(set_idx, tag);
-    LOG_IF(cfg::kLogCache, "[CACHE PE" << pe_ << "] STORE addr=0x"
-                                       << std::hex << addr << std::dec << " set=" << set_idx
-                                       << " tag=" << tag << (way >= 0 ? " (hit)" : " (miss)"));
+    LOGF(cfg::kLogCache, "[CACHE PE{}] STORE addr=0x{x} set={} tag={}{}",
+         pe_, addr, set_idx, tag, way >= 0 ? " (hit)" : " (miss)");
     if (way >= 0)
       return write_hit(set_idx, way, addr, size, value);
     return handle_store_miss(addr, size, value);
   }
 
-  bool Cache::snoop(const BusRequest &req, std::optional<Word> &data_out)
+  bool Cache::snoop(const BusRequest &req, std::optional<Word> &data_out, LineXfer *xfer)
   {
     // Nota: si hacemos Flush, seteamos data_out.emplace(0) para que el Bus
     //       contabilice flushes/bytes de intervención. (El contenido real no importa)
@@ -233,61 +436,90 @@ namespace sim
     int way = find_way(set_idx, tag);
     if (way < 0)
     {
-      LOG_IF(cfg::kLogSnoop, "[SNOOP PE" << pe_ << "] cmd=" << (int)req.cmd
-                                         << " addr=0x" << std::hex << req.addr << std::dec
-                                         << " -> línea no presente");
+      LOGF(cfg::kLogSnoop, "[SNOOP PE{}] cmd={} addr=0x{x} -> línea no presente",
+           pe_, static_cast<int>(req.cmd), req.addr);
       return false;
     }
 
-    auto &line = sets_[set_idx].ways[way];
-    LOG_IF(cfg::kLogSnoop, "[SNOOP PE" << pe_ << "] cmd=" << (int)req.cmd
-                                       << " addr=0x" << std::hex << req.addr << std::dec
-                                       << " estado=" << to_string(line.state));
+    const std::size_t sl = slot(set_idx, way);
+    LOGF(cfg::kLogSnoop, "[SNOOP PE{}] cmd={} addr=0x{x} estado={}",
+         pe_, static_cast<int>(req.cmd), req.addr, to_string(states_[sl]));
 
     auto flush_full_line = [&](bool count_flush_metric){
-      Addr base = line_base(req.addr);
-      for (std::size_t off = 0; off < line_bytes_; off += sizeof(Word)) {
-        Word w;
-        std::memcpy(&w, line.data.data() + off, sizeof(Word));
-        mem_.write64(base + off, w);
-      }
+      write_line_to_mem(sl, line_base(req.addr));
+      bump(metrics_.dram_write_bytes, line_bytes_);
       if (count_flush_metric) {
-        metrics_.flushes++;
+        bump(metrics_.flushes);
         data_out.emplace(0); // señalamos al Bus que hubo provisión de datos
       }
     };
 
+    // MOESI/MESIF: la línea va directo al que pidió (una sola caché provee)
+    auto supply = [&]() -> bool {
+      if (!xfer || xfer->filled) return false;
+      std::memcpy(xfer->data, line_data(sl), line_bytes_);
+      xfer->filled = true;
+      bump(metrics_.c2c_supplies);
+      data_out.emplace(0);
+      LOGF(cfg::kLogSnoop, "  -> provee la línea caché a caché");
+      return true;
+    };
+
     switch (req.cmd)
     {
     case BusCmd::BusRd:
-      if (line.state == MESI::M) {
+      if (states_[sl] == MESI::M && protocol_ == Protocol::MOESI) {
+        // Se queda como dueña de la copia sucia: DRAM no se toca
+        supply();
+        states_[sl] = MESI::O;
+        bump(metrics_.dram_writes_avoided, line_bytes_);
+        LOGF(cfg::kLogSnoop, "  -> M->O (sin Flush a DRAM)");
+      } else if (states_[sl] == MESI::M) {
         // Si estuviera sucia (teóricamente podría ocurrir si WT se desactiva)
         flush_full_line(true);
-        line.state = MESI::S;
-        line.dirty = false;
-        metrics_.trans_m_to_s++;
-        LOG_IF(cfg::kLogSnoop, "  -> Flush + degradar a S");
-      } else if (line.state == MESI::E) {
-        line.state = MESI::S;
-        metrics_.trans_e_to_s++;
-        LOG_IF(cfg::kLogSnoop, "  -> degradar E->S");
+        if (protocol_ == Protocol::MESIF) supply();
+        states_[sl] = MESI::S;
+        dirty_[sl] = false;
+        bump(metrics_.trans_m_to_s);
+        LOGF(cfg::kLogSnoop, "  -> Flush + degradar a S");
+      } else if (states_[sl] == MESI::O) {
+        supply();
+      } else if (states_[sl] == MESI::E) {
+        if (protocol_ == Protocol::MESIF) supply();
+        states_[sl] = MESI::S;
+        bump(metrics_.trans_e_to_s);
+        LOGF(cfg::kLogSnoop, "  -> degradar E->S");
+      } else if (states_[sl] == MESI::F) {
+        // El que pide pasa a ser el forwarder
+        supply();
+        states_[sl] = MESI::S;
+        LOGF(cfg::kLogSnoop, "  -> F->S");
       }
       return true;
 
     case BusCmd::BusRdX:
     case BusCmd::BusUpgr:
-      if (line.state == MESI::M && line.dirty) {
-        flush_full_line(true);
-        LOG_IF(cfg::kLogSnoop, "  -> Flush por RdX/Upgr (dirty)");
+      if ((states_[sl] == MESI::M && dirty_[sl]) || states_[sl] == MESI::O) {
+        // El que escribe se lleva la copia sucia: con MOESI/MESIF no pasa por DRAM
+        if (protocol_ != Protocol::MESI && supply()) {
+          bump(metrics_.dram_writes_avoided, line_bytes_);
+        } else {
+          flush_full_line(true);
+          LOGF(cfg::kLogSnoop, "  -> Flush por RdX/Upgr (dirty)");
+        }
+      } else if (req.cmd == BusCmd::BusRdX && protocol_ == Protocol::MESIF &&
+                 (states_[sl] == MESI::E || states_[sl] == MESI::F)) {
+        supply();
       }
-      if (line.state != MESI::I) {
-        // {S,E,M} -> I
-        line.state = MESI::I;
-        line.valid = false;
-        line.dirty = false;
-        metrics_.invalidations++;
-        metrics_.trans_x_to_i++;
-        LOG_IF(cfg::kLogSnoop, "  -> Invalidate línea (I)");
+      if (states_[sl] != MESI::I) {
+        // {S,E,M,O,F} -> I
+        states_[sl] = MESI::I;
+        valid_[sl] = false;
+        dirty_[sl] = false;
+        tags_[sl]  = tagmatch::kNoTag;
+        bump(metrics_.invalidations);
+        bump(metrics_.trans_x_to_i);
+        LOGF(cfg::kLogSnoop, "  -> Invalidate línea (I)");
         return true;
       }
       return false;
@@ -303,7 +535,7 @@ namespace sim
                          bool dump_data) const
   {
     os << "=== Cache PE" << pe_ << " | sets=" << num_sets_
-       << " ways=" << cfg::kCacheWays
+       << " ways=" << ways_
        << " line=" << line_bytes_ << "B ===\n";
 
     std::size_t hi_set = 0;
@@ -316,21 +548,24 @@ namespace sim
 
     for (std::size_t s = 0; s < num_sets_; ++s) {
       os << "Set " << s << ":\n";
-      for (std::size_t w = 0; w < sets_[s].ways.size(); ++w) {
-        const auto& line = sets_[s].ways[w];
-        bool mark = has_hi && line.valid && (line.tag == hi_tag) && (s == hi_set);
+      for (std::size_t w = 0; w < ways_; ++w) {
+        const std::size_t sl = slot(s, static_cast<int>(w));
+        bool mark = has_hi && valid_[sl] && (tags_[sl] == hi_tag) && (s == hi_set);
         os << "  Way " << w
-           << " | V=" << (line.valid ? 1 : 0)
-           << " | Tag=0x" << std::hex << line.tag << std::dec
-           << " | State=" << to_string(line.state)
-           << " | D=" << (line.dirty ? 1 : 0)
+           << " | V=" << (valid_[sl] ? 1 : 0)
+           << " | Tag=";
+        if (tags_[sl] == tagmatch::kNoTag) os << "-";
+        else os << "0x" << std::hex << tags_[sl] << std::dec;
+        os
+           << " | State=" << to_string(states_[sl])
+           << " | D=" << (dirty_[sl] ? 1 : 0)
            << (mark ? "   *" : "")
            << "\n";
-        if (dump_data && line.valid) {
+        if (dump_data && valid_[sl]) {
           // Vuelca las palabras de 64b de la línea
           for (std::size_t off = 0; off < line_bytes_; off += sizeof(Word)) {
             Word u;
-            std::memcpy(&u, line.data.data() + off, sizeof(Word));
+            std::memcpy(&u, line_data(sl) + off, sizeof(Word));
             os << "      [+" << std::setw(2) << off << "] u64=0x"
                << std::hex << u << std::dec;
             double d;
@@ -0,0 +1,18 @@
+#include "directory.hpp"
+
+namespace sim
+{
+
+Directory::Directory(const SimConfig& cfg) : map_(cfg) {}
+
+void Directory::remove_sharer(Addr line_addr, PEId pe) {
+  evict_notices_.fetch_add(1, std::memory_order_relaxed);
+  map_.remove(line_addr, pe);
+}
+
+SharerMap::Line Directory::lookup(Addr line_addr) {
+  lookups_.fetch_add(1, std::memory_order_relaxed);
+  return map_.get(line_addr);
+}
+
+} // namespace sim
@@ -0,0 +1,184 @@
+#include "log.hpp"
+#include "config.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim::log
+{
+
+namespace {
+
+// Formatea un registro (en el drenador, fuera del hot path)
+void format_record(std::string& out, const Record& r) {
+  char num[32];
+  auto put_uint = [&](std::uint64_t v, int base) {
+    auto res = std::to_chars(num, num + sizeof num, v, base);
+    out.append(num, res.ptr);
+  };
+
+  std::size_t i = 0;
+  for (const char* p = r.fmt; *p; ++p) {
+    if (*p != '{') { out.push_back(*p); continue; }
+    const char* e = std::strchr(p, '}');
+    if (!e || i >= kMaxArgs) { out.append(p); break; }
+    const std::string_view spec(p + 1, static_cast<std::size_t>(e - p - 1));
+    const Arg           t = static_cast<Arg>((r.types >> (4 * i)) & 0xF);
+    const std::uint64_t v = r.args[i++];
+    p = e;
+
+    if (spec == "x") {
+      put_uint(v, 16);
+    } else if (spec == "pes") {
+      // Dos argumentos: máscara de PE0..PE63 y cuántos más (PE >= 64)
+      const std::uint64_t more = i < kMaxArgs ? r.args[i++] : 0;
+      if (!v && !more) { out += "none"; continue; }
+      bool first = true;
+      for (std::uint64_t b = v; b; b &= b - 1) {
+        if (!first) out.push_back(',');
+        first = false;
+        out += "PE";
+        put_uint(static_cast<std::uint64_t>(__builtin_ctzll(b)), 10);
+      }
+      if (more) { out += first ? "+" : ",+"; put_uint(more, 10); }
+    } else if (spec == "regs") {
+      // Terna de registros empaquetada como en Instr::target de FMULADD
+      for (int k = 0; k < 3; ++k) {
+        if (k) out += ", ";
+        out.push_back('R');
+        put_uint((v >> (8 * k)) & 0xFF, 10);
+      }
+    } else if (t == Arg::F64) {
+      double d;
+      std::memcpy(&d, &v, sizeof d);
+      const int n = spec == "f" ? std::snprintf(num, sizeof num, "%.6f", d)
+                                : std::snprintf(num, sizeof num, "%g", d);
+      out.append(num, static_cast<std::size_t>(std::max(0, std::min<int>(n, sizeof num - 1))));
+    } else if (t == Arg::Str) {
+      out += reinterpret_cast<const char*>(static_cast<std::uintptr_t>(v));
+    } else if (t == Arg::I64) {
+      auto res = std::to_chars(num, num + sizeof num, static_cast<std::int64_t>(v));
+      out.append(num, res.ptr);
+    } else {
+      put_uint(v, 10);
+    }
+  }
+  out.push_back('\n');
+}
+
+class Drainer {
+public:
+  Drainer() : th_([this] { loop(); }) {}
+
+  ~Drainer() {
+    {
+      std::scoped_lock lk(cv_m_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    th_.join();
+    drain();
+  }
+
+  Ring& add_ring() {
+    std::scoped_lock lk(reg_m_);
+    rings_.push_back(std::make_unique<Ring>());
+    return *rings_.back();
+  }
+
+  void wake() { cv_.notify_one(); }
+
+  // Único consumidor de los rings a la vez (el hilo drenador o quien llame a flush)
+  void drain() {
+    std::scoped_lock lk(drain_m_);
+    batch_.clear();
+    {
+      std::scoped_lock rl(reg_m_);
+      for (auto it = rings_.begin(); it != rings_.end();) {
+        Ring& r = **it;
+        const bool          gone = r.retired.load(std::memory_order_acquire);
+        const std::uint64_t h    = r.head.load(std::memory_order_acquire);
+        const std::uint64_t t    = r.tail.load(std::memory_order_relaxed);
+        for (std::uint64_t k = t; k < h; ++k) batch_.push_back(r.buf[k & (Ring::kCap - 1)]);
+        r.tail.store(h, std::memory_order_release);
+        if (gone) it = rings_.erase(it);  // el hilo ya no escribe más
+        else      ++it;
+      }
+    }
+    if (batch_.empty()) return;
+
+    // Orden global (seq de 32 bits: se compara la diferencia, tolera la vuelta)
+    std::stable_sort(batch_.begin(), batch_.end(), [](const Record& a, const Record& b) {
+      return static_cast<std::int32_t>(a.seq - b.seq) < 0;
+    });
+    text_.clear();
+    for (const auto& r : batch_) format_record(text_, r);
+    SERR << text_;
+  }
+
+private:
+  void loop() {
+    std::unique_lock lk(cv_m_);
+    while (!stop_) {
+      cv_.wait_for(lk, std::chrono::milliseconds(5));
+      lk.unlock();
+      drain();
+      lk.lock();
+    }
+  }
+
+  std::mutex                         reg_m_;    // rings_
+  std::vector<std::unique_ptr<Ring>> rings_;
+  std::mutex                         drain_m_;  // batch_/text_ y consumo de los rings
+  std::vector<Record>                batch_;
+  std::string                        text_;
+  std::mutex                         cv_m_;
+  std::condition_variable            cv_;
+  bool                               stop_ = false;
+  std::thread                        th_;
+};
+
+std::atomic<bool> g_started{false};  // ¿algún hilo logueó? (si no, flush no hace nada)
+
+Drainer& drainer() {
+  static Drainer d;
+  return d;
+}
+
+// Marca el ring como retirado cuando termina el hilo dueño
+struct RetireOnExit {
+  ~RetireOnExit() { if (t_ring) t_ring->retired.store(true, std::memory_order_release); }
+};
+thread_local RetireOnExit t_retire;
+
+} // namespace
+
+Ring& register_thread() {
+  (void)&t_retire;  // instancia el thread_local de este hilo
+  t_ring = &drainer().add_ring();
+  g_started.store(true, std::memory_order_release);
+  return *t_ring;
+}
+
+void wait_for_space(Ring& r) {
+  const std::uint64_t h = r.head.load(std::memory_order_relaxed);
+  while (h - r.tail.load(std::memory_order_acquire) >= Ring::kCap) {
+    drainer().wake();
+    std::this_thread::yield();
+  }
+}
+
+void wake_drainer() { drainer().wake(); }
+
+void flush() {
+  if (g_started.load(std::memory_order_acquire)) drainer().drain();
+}
+
+} // namespace sim::log
@@ -0,0 +1,144 @@
+#include "mem_image.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim::memimage {
+
+namespace {
+
+constexpr char        kMagic[8] = {'M', 'P', 'M', 'I', 'M', 'G', '0', '1'};
+constexpr std::size_t kPage     = Memory::kPageBytes;
+
+struct SegHeader {
+  std::uint64_t base;
+  std::uint64_t bytes;
+  std::uint64_t file_off;
+};
+
+// Dueño del mmap: Memory lo guarda mientras use páginas prestadas
+struct Mapping {
+  void*       p = MAP_FAILED;
+  std::size_t n = 0;
+  ~Mapping() { if (p != MAP_FAILED) munmap(p, n); }
+};
+
+std::size_t align_up(std::size_t x) { return (x + kPage - 1) / kPage * kPage; }
+
+} // namespace
+
+LoadStats load(const std::string& path, Memory& mem) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("No se puede abrir mem-image: " + path);
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || st.st_size < 16) {
+    ::close(fd);
+    throw std::runtime_error("mem-image inválida (muy chica): " + path);
+  }
+
+  // Privado y escribible: Memory puede escribir las páginas prestadas (COW)
+  auto map = std::make_shared<Mapping>();
+  map->n = static_cast<std::size_t>(st.st_size);
+  map->p = ::mmap(nullptr, map->n, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map->p == MAP_FAILED) throw std::runtime_error("mmap falló: " + path);
+
+  auto* file = static_cast<std::uint8_t*>(map->p);
+  if (std::memcmp(file, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("mem-image sin magic MPMIMG01: " + path);
+
+  std::uint64_t nsegs = 0;
+  std::memcpy(&nsegs, file + 8, sizeof(nsegs));
+  if (nsegs > (map->n - 16) / sizeof(SegHeader))
+    throw std::runtime_error("mem-image truncada (tabla de segmentos): " + path);
+
+  const Addr limit = static_cast<Addr>(mem.words()) * cfg::kWordBytes;
+  LoadStats stats;
+  for (std::uint64_t i = 0; i < nsegs; ++i) {
+    SegHeader h;
+    std::memcpy(&h, file + 16 + i * sizeof(SegHeader), sizeof(h));
+    if (h.file_off > map->n || h.bytes > map->n - h.file_off)
+      throw std::runtime_error("mem-image truncada (segmento " + std::to_string(i) + "): " + path);
+    if (h.base > limit || h.bytes > limit - h.base)
+      throw std::runtime_error("mem-image: el segmento " + std::to_string(i) +
+                               " no entra en mem-words (usar --mem-words más grande)");
+
+    std::uint8_t* data = file + h.file_off;
+    std::size_t   done = 0;
+    // Páginas enteras, con base y datos alineados: se prestan sin copiar
+    if (h.base % kPage == 0 && h.file_off % kPage == 0) {
+      const std::size_t pages = h.bytes / kPage;
+      if (pages) mem.map_pages(h.base, data, pages, map);
+      done = pages * kPage;
+      stats.mapped_bytes += done;
+    }
+    // Resto (bordes o segmentos desalineados): copia
+    if (done < h.bytes) {
+      mem.write_aligned(h.base + done, data + done, h.bytes - done, 1);
+      stats.copied_bytes += h.bytes - done;
+    }
+    ++stats.segments;
+  }
+  return stats;
+}
+
+std::size_t save(const std::string& path, const Memory& mem) {
+  // Páginas presentes agrupadas en tramos contiguos
+  std::vector<SegHeader> segs;
+  const Addr limit = static_cast<Addr>(mem.words()) * cfg::kWordBytes;
+  mem.for_each_resident_page([&](Addr page) {
+    const std::uint64_t n = std::min<Addr>(kPage, limit - page);
+    if (!segs.empty() && segs.back().base + segs.back().bytes == page) segs.back().bytes += n;
+    else segs.push_back({page, n, 0});
+  });
+
+  std::size_t off = align_up(16 + segs.size() * sizeof(SegHeader));
+  for (auto& s : segs) {
+    s.file_off = off;
+    off = align_up(off + s.bytes);
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) throw std::runtime_error("No se puede escribir snapshot: " + path);
+  const std::uint64_t nsegs = segs.size();
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char*>(&nsegs), sizeof(nsegs));
+  out.write(reinterpret_cast<const char*>(segs.data()),
+            static_cast<std::streamsize>(segs.size() * sizeof(SegHeader)));
+
+  std::vector<std::uint8_t> buf(kPage);
+  for (const auto& s : segs) {
+    out.seekp(static_cast<std::streamoff>(s.file_off));
+    for (std::uint64_t done = 0; done < s.bytes; done += kPage) {
+      const std::size_t n = std::min<std::uint64_t>(kPage, s.bytes - done);
+      mem.read_aligned(s.base + done, buf.data(), n, 1);
+      out.write(reinterpret_cast<const char*>(buf.data()), static_cast<std::streamsize>(n));
+    }
+  }
+  // Relleno final: el último segmento también queda en páginas enteras del archivo
+  if (!segs.empty()) {
+    out.seekp(static_cast<std::streamoff>(off - 1));
+    out.put('\0');
+  }
+  if (!out) throw std::runtime_error("Error escribiendo snapshot: " + path);
+  return segs.size();
+}
+
+void check_writable(const std::string& path) {
+  struct stat st;
+  const bool existed = ::stat(path.c_str(), &st) == 0;
+  const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+  if (fd < 0) throw std::runtime_error("No se puede escribir snapshot: " + path);
+  ::close(fd);
+  if (!existed) ::unlink(path.c_str());
+}
+
+} // namespace sim::memimage
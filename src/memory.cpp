@@ -1,58 +1,169 @@
 #include "memory.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cstring> // std::memcpy
 #include <cstdint>
 
 namespace sim {
 
-Memory::Memory() : mem_(cfg::kMemWords, 0) {}
+Memory::Memory(const SimConfig& cfg)
+    : bytes_(cfg.mem_words * cfg::kWordBytes), line_bytes_(cfg.line_bytes),
+      l1_((bytes_ + (kPageBytes << kL2Bits) - 1) / (kPageBytes << kL2Bits)) {}
 
-// Helper interno: rango válido (en bytes) sobre el backing store
-static inline std::size_t mem_size_bytes(const std::vector<Word>& v) {
-  return v.size() * cfg::kWordBytes;
+Memory::~Memory() {
+  for (auto& e : l1_) {
+    L2* t = e.load(std::memory_order_relaxed);
+    if (!t) continue;
+    for (std::size_t j = 0; j < kL2Entries; ++j)
+      if (!t->borrowed.test(j)) delete t->pages[j].load(std::memory_order_relaxed);
+    delete t;
+  }
+}
+
+std::size_t Memory::in_range(Addr addr, std::size_t bytes) const {
+  if (addr >= bytes_) return 0;
+  return std::min<std::size_t>(bytes, bytes_ - addr);
+}
+
+// ---------- Tabla de páginas ----------
+const std::uint8_t* Memory::page_for_read(Addr addr) const {
+  const L2* t = l1_[addr >> (kPageBits + kL2Bits)].load(std::memory_order_acquire);
+  if (!t) return nullptr;
+  const Page* p = t->pages[(addr >> kPageBits) & (kL2Entries - 1)].load(std::memory_order_acquire);
+  return p ? p->bytes : nullptr;
+}
+
+Memory::L2& Memory::table_for(Addr addr) {
+  // Primera escritura: se asigna (en cero) y se publica con CAS; si otro hilo
+  // ganó la carrera se usa la suya
+  auto& e = l1_[addr >> (kPageBits + kL2Bits)];
+  L2* t = e.load(std::memory_order_acquire);
+  if (!t) {
+    auto* fresh = new L2();
+    if (e.compare_exchange_strong(t, fresh, std::memory_order_acq_rel)) t = fresh;
+    else delete fresh;
+  }
+  return *t;
+}
+
+std::uint8_t* Memory::page_for_write(Addr addr) {
+  auto& slot = table_for(addr).pages[(addr >> kPageBits) & (kL2Entries - 1)];
+  Page* p = slot.load(std::memory_order_acquire);
+  if (!p) {
+    auto* fresh = new Page();
+    if (slot.compare_exchange_strong(p, fresh, std::memory_order_acq_rel)) {
+      p = fresh;
+      resident_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      delete fresh;
+    }
+  }
+  return p->bytes;
+}
+
+void Memory::map_pages(Addr base, std::uint8_t* data, std::size_t pages,
+                       std::shared_ptr<void> owner) {
+  assert(base % kPageBytes == 0);
+  for (std::size_t i = 0; i < pages; ++i) {
+    const Addr a = base + i * kPageBytes;
+    std::uint8_t* src = data + i * kPageBytes;
+    if (in_range(a, kPageBytes) != kPageBytes) {
+      // Última página parcial del espacio de direcciones: se copia lo que entra
+      write_aligned(a, src, in_range(a, kPageBytes), 1);
+      continue;
+    }
+    L2& t = table_for(a);
+    const std::size_t j = (a >> kPageBits) & (kL2Entries - 1);
+    if (t.pages[j].load(std::memory_order_relaxed)) {
+      std::memcpy(page_for_write(a), src, kPageBytes);
+      continue;
+    }
+    t.pages[j].store(reinterpret_cast<Page*>(src), std::memory_order_release);
+    t.borrowed.set(j);
+    ++mapped_;
+  }
+  owners_.push_back(std::move(owner));
 }
 
 Word Memory::read64(Addr addr) const {
-  std::scoped_lock lk(mtx_);
   // Direccionamiento por palabras de 8 bytes (alineado por simplicidad)
   assert(addr % cfg::kWordBytes == 0);
-  std::size_t idx = addr / cfg::kWordBytes;
-  if (idx >= mem_.size()) return 0;
-  return mem_[idx];
+  if (in_range(addr, cfg::kWordBytes) != cfg::kWordBytes) return 0;
+  const std::uint8_t* pg = page_for_read(addr);
+  if (!pg) return 0;
+  Word w;
+  std::scoped_lock lk(lock_of(addr));
+  std::memcpy(&w, pg + addr % kPageBytes, sizeof(Word));
+  return w;
 }
 
 void Memory::write64(Addr addr, Word value) {
-  std::scoped_lock lk(mtx_);
   assert(addr % cfg::kWordBytes == 0);
-  std::size_t idx = addr / cfg::kWordBytes;
-  if (idx < mem_.size()) mem_[idx] = value;
+  if (in_range(addr, cfg::kWordBytes) != cfg::kWordBytes) return;
+  std::uint8_t* pg = page_for_write(addr);
+  std::scoped_lock lk(lock_of(addr));
+  std::memcpy(pg + addr % kPageBytes, &value, sizeof(Word));
+}
+
+// --- Línea completa: un memcpy bajo el lock de su stripe (nunca cruza página) ---
+void Memory::read_line(Addr base, void* dst) const {
+  assert(base % line_bytes_ == 0);
+  const std::size_t n = in_range(base, line_bytes_);
+  const std::uint8_t* pg = n ? page_for_read(base) : nullptr;
+  if (pg) {
+    std::scoped_lock lk(lock_of(base));
+    std::memcpy(dst, pg + base % kPageBytes, n);
+  }
+  const std::size_t got = pg ? n : 0;
+  if (got < line_bytes_) std::memset(static_cast<std::uint8_t*>(dst) + got, 0, line_bytes_ - got);
+}
+
+void Memory::write_line(Addr base, const void* src) {
+  assert(base % line_bytes_ == 0);
+  const std::size_t n = in_range(base, line_bytes_);
+  if (!n) return;
+  std::uint8_t* pg = page_for_write(base);
+  std::scoped_lock lk(lock_of(base));
+  std::memcpy(pg + base % kPageBytes, src, n);
 }
 
 // --- API genérica de alineamiento ---
 // Permite leer cualquier tamaño "bytes" siempre que addr y bytes respeten "align".
+// Se copia de a una línea, cada tramo bajo el lock de su stripe.
 bool Memory::read_aligned(Addr addr, void* dst, std::size_t bytes, std::size_t align) const {
   if (align == 0) return false;
   if ((addr % align) != 0 || (bytes % align) != 0) return false;
+  if (in_range(addr, bytes) != bytes) return false;
 
-  std::scoped_lock lk(mtx_);
-  const std::size_t total = mem_size_bytes(mem_);
-  if (addr + bytes > total) return false;
-
-  const std::uint8_t* base = reinterpret_cast<const std::uint8_t*>(mem_.data());
-  std::memcpy(dst, base + addr, bytes);
+  auto* out = static_cast<std::uint8_t*>(dst);
+  for (std::size_t done = 0; done < bytes; ) {
+    const Addr a = addr + done;
+    const std::size_t chunk = std::min<std::size_t>(bytes - done, line_bytes_ - a % line_bytes_);
+    if (const std::uint8_t* pg = page_for_read(a)) {
+      std::scoped_lock lk(lock_of(a));
+      std::memcpy(out + done, pg + a % kPageBytes, chunk);
+    } else {
+      std::memset(out + done, 0, chunk);
+    }
+    done += chunk;
+  }
   return true;
 }
 
 bool Memory::write_aligned(Addr addr, const void* src, std::size_t bytes, std::size_t align) {
   if (align == 0) return false;
   if ((addr % align) != 0 || (bytes % align) != 0) return false;
+  if (in_range(addr, bytes) != bytes) return false;
 
-  std::scoped_lock lk(mtx_);
-  const std::size_t total = mem_size_bytes(mem_);
-  if (addr + bytes > total) return false;
-
-  std::uint8_t* base = reinterpret_cast<std::uint8_t*>(mem_.data());
-  std::memcpy(base + addr, src, bytes);
+  const auto* in = static_cast<const std::uint8_t*>(src);
+  for (std::size_t done = 0; done < bytes; ) {
+    const Addr a = addr + done;
+    const std::size_t chunk = std::min<std::size_t>(bytes - done, line_bytes_ - a % line_bytes_);
+    std::uint8_t* pg = page_for_write(a);
+    std::scoped_lock lk(lock_of(a));
+    std::memcpy(pg + a % kPageBytes, in + done, chunk);
+    done += chunk;
+  }
   return true;
 }
 
@@ -2,11 +2,14 @@
 #include "cache.hpp"
 #include "config.hpp"
 #include "assembler.hpp"
+#include "trace.hpp"
+#include "recorder.hpp"
+#include <algorithm>
+#include <bit>
 #include <cstring>
 #include <stdexcept>
 #include <unordered_map>
 #include <iostream>
-#include <iomanip>
 
 namespace sim
 {
@@ -15,12 +18,29 @@ namespace sim
   // - load_*: carga programa/traza
   // - step(): avanza 1 instrucción/acceso
   // - mem_*64: accesos de 64 bits vía caché
-  Processor::Processor(PEId id, Cache &cache) : id_(id), cache_(cache) {}
+  Processor::Processor(PEId id, Cache &cache)
+      : id_(id), cache_(cache),
+        vl_(std::bit_floor(std::clamp<std::size_t>(cache.line_bytes() / cfg::kWordBytes, 1, vecops::kMaxLanes))) {}
+
+  Processor::~Processor() = default;
 
   void Processor::load_trace(const std::vector<Access> &trace)
   {
     trace_ = trace;
     pc_trace_ = 0;
+    reader_.reset();
+    cur_.reset();
+    trace_eof_ = false;
+    mode_ = ExecMode::Trace;
+  }
+
+  void Processor::load_trace(std::unique_ptr<TraceReader> reader)
+  {
+    trace_.clear();
+    pc_trace_ = 0;
+    reader_ = std::move(reader);
+    cur_.reset();
+    trace_eof_ = false;
     mode_ = ExecMode::Trace;
   }
 
@@ -28,7 +48,42 @@ namespace sim
   {
     prog_ = p;
     pc_ = 0;
+    owed_ = 0;
+    vload_off_ = 0;
     mode_ = ExecMode::ISA;
+    build_blocks();
+  }
+
+  // Bloques básicos: arrancan en pc 0, en cada destino de JNZ y después de cada
+  // JNZ. Sólo se fusionan pares dentro de un bloque (nadie salta a la 2da) y sin
+  // memoria de por medio (nunca quedan a medias por un stall del bus).
+  void Processor::build_blocks()
+  {
+    const auto &code = prog_.code;
+    std::vector<bool> leader(code.size() + 1, false);
+    leader[0] = true;
+    for (std::size_t i = 0; i < code.size(); ++i) {
+      if (code[i].op != OpCode::JNZ) continue;
+      if (code[i].target <= code.size()) leader[code[i].target] = true;
+      leader[i + 1] = true;
+    }
+
+    blocks_ = code;
+    for (std::size_t i = 0; i + 1 < code.size(); ++i) {
+      if (leader[i + 1]) continue;
+      const Instr &a = code[i], &b = code[i + 1];
+      Instr &f = blocks_[i];
+      if (a.op == OpCode::FMUL && b.op == OpCode::FADD) {
+        f.op     = OpCode::FMULADD;
+        f.target = b.rd | (std::uint32_t{b.ra} << 8) | (std::uint32_t{b.rb} << 16);
+      } else if (a.op == OpCode::DEC && b.op == OpCode::JNZ) {
+        f.op     = OpCode::DECJNZ;
+        f.target = b.target;
+      } else {
+        continue;
+      }
+      ++i;  // la 2da no arranca otro par
+    }
   }
 
   void Processor::load_program_from_string(const std::string &asm_source)
@@ -72,17 +127,28 @@ namespace sim
     return v;
   }
 
-  // ===== Accesos a memoria (64 bits) vía caché =====
+  // ===== Accesos a memoria vía caché =====
+  // Con grabación activa, el acceso se registra al completarse (no en cada
+  // reintento mientras la caché espera al bus), con el tick del primer intento.
+  void Processor::cache_access(AccessType type, Addr addr, std::size_t size, void *inout)
+  {
+    if (rec_ && !cache_.stalled()) rec_issue_ = rec_->tick();
+    if (type == AccessType::Load) (void)cache_.load_block(addr, size, inout);
+    else                          (void)cache_.store(addr, size, *static_cast<const Word *>(inout));
+    if (rec_ && !cache_.stalled()) rec_->access(id_, rec_issue_, type, addr, size);
+  }
+
   std::uint64_t Processor::mem_load64(std::uint64_t addr)
   {
     Word out = 0;
-    (void)cache_.load(static_cast<Addr>(addr), sizeof(Word), out);
+    cache_access(AccessType::Load, static_cast<Addr>(addr), sizeof(Word), &out);
     return out;
   }
 
   void Processor::mem_store64(std::uint64_t addr, std::uint64_t val)
   {
-    (void)cache_.store(static_cast<Addr>(addr), sizeof(Word), static_cast<Word>(val));
+    Word v = static_cast<Word>(val);
+    cache_access(AccessType::Store, static_cast<Addr>(addr), sizeof(Word), &v);
   }
 
   // ===== Ejecución ISA (una instrucción) =====
@@ -90,32 +156,33 @@ namespace sim
   {
     if (pc_ >= prog_.code.size())
       return;
-    const Instr &ins = prog_.code[pc_];
+    const Instr &ins = (fusion_ ? blocks_ : prog_.code)[pc_];
 
-    auto next = [&]{ pc_++; };
+    auto next  = [&]{ pc_++; ++fstats_.retired; };
+    auto vnext = [&]{ next(); ++vec_retired_; };
 
     switch (ins.op)
     {
     case OpCode::LOAD: {
       // LOAD Rd, [Rs]
-      auto dst = ins.rd;
-      auto src = ins.ra;
+      const int dst = ins.rd;
+      const int src = ins.ra;
       std::uint64_t addr = reg_[src];
       std::uint64_t val = mem_load64(addr);
+      if (cache_.stalled()) break;  // write-back: miss en vuelo, se reintenta
       reg_[dst] = val;
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] LOAD R" << dst << ", [R" << src << "] @0x"
-                                << std::hex << addr << std::dec);
+      LOGF(cfg::kLogPE, "[PE{}] LOAD R{}, [R{}] @0x{x}", id_, dst, src, addr);
       next();
       break;
     }
     case OpCode::STORE: {
       // STORE Rs, [Rd]
-      auto src = ins.ra;
-      auto dst = ins.rd;
+      const int src = ins.ra;
+      const int dst = ins.rd;
       std::uint64_t addr = reg_[dst];
       mem_store64(addr, reg_[src]);
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] STORE R" << src << " -> [R" << dst << "] @0x"
-                                << std::hex << addr << std::dec);
+      if (cache_.stalled()) break;
+      LOGF(cfg::kLogPE, "[PE{}] STORE R{} -> [R{}] @0x{x}", id_, src, dst, addr);
       next();
       break;
     }
@@ -123,7 +190,7 @@ namespace sim
       double a = as_double(reg_[ins.ra]);
       double b = as_double(reg_[ins.rb]);
       reg_[ins.rd] = from_double(a * b);
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] FMUL R" << ins.rd << ", R" << ins.ra << ", R" << ins.rb);
+      LOGF(cfg::kLogPE, "[PE{}] FMUL R{}, R{}, R{}", id_, ins.rd, ins.ra, ins.rb);
       next();
       break;
     }
@@ -131,85 +198,183 @@ namespace sim
       double a = as_double(reg_[ins.ra]);
       double b = as_double(reg_[ins.rb]);
       reg_[ins.rd] = from_double(a + b);
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] FADD R" << ins.rd << ", R" << ins.ra << ", R" << ins.rb);
+      LOGF(cfg::kLogPE, "[PE{}] FADD R{}, R{}, R{}", id_, ins.rd, ins.ra, ins.rb);
       next();
       break;
     }
     case OpCode::REDUCE: {
       // sumatoria en memoria: sum_{i=0..count-1} [base + i*8]
+      // Reanudable: si un load queda esperando al bus, el tick siguiente sigue en i
       std::uint64_t base = reg_[ins.ra];
       std::uint64_t count = reg_[ins.rb];
-      double sum = 0.0;
-      for (std::uint64_t i = 0; i < count; ++i) {
-        Word v = mem_load64(base + i * cfg::kWordBytes);
-        sum += as_double(v);
+      for (; reduce_i_ < count; ++reduce_i_) {
+        Word v = mem_load64(base + reduce_i_ * cfg::kWordBytes);
+        if (cache_.stalled()) return;
+        reduce_acc_ += as_double(v);
       }
+      const double sum = reduce_acc_;
+      reduce_i_ = 0;
+      reduce_acc_ = 0.0;
       reg_[ins.rd] = from_double(sum);
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] REDUCE R" << ins.rd
-                                << " base=0x" << std::hex << base << std::dec
-                                << " count=" << count
-                                << " -> " << std::fixed << std::setprecision(6) << sum);
+      LOGF(cfg::kLogPE, "[PE{}] REDUCE R{} base=0x{x} count={} -> {f}", id_, ins.rd, base, count, sum);
       next();
       break;
     }
     case OpCode::INC: {
       reg_[ins.rd] += cfg::kWordBytes; // puntero +8
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] INC R" << ins.rd << " (+" << cfg::kWordBytes << ")");
+      LOGF(cfg::kLogPE, "[PE{}] INC R{} (+{})", id_, ins.rd, cfg::kWordBytes);
       next();
       break;
     }
     case OpCode::DEC: {
       reg_[ins.rd] -= 1;
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] DEC R" << ins.rd);
+      LOGF(cfg::kLogPE, "[PE{}] DEC R{}", id_, ins.rd);
       next();
       break;
     }
     case OpCode::MOVI: {
       reg_[ins.rd] = ins.imm;
-      LOG_IF(cfg::kLogPE, "[PE" << id_ << "] MOVI R" << ins.rd << ", " << ins.imm);
+      LOGF(cfg::kLogPE, "[PE{}] MOVI R{}, {}", id_, ins.rd, ins.imm);
       next();
       break;
     }
     case OpCode::JNZ: {
-      // REG0 = contador implícito
-      const auto &L = labels_map();
-      auto it = L.find(ins.label);
-      if (it == L.end())
-        throw std::runtime_error("Label no encontrado: " + ins.label);
+      // REG0 = contador implícito; el destino viene resuelto del Assembler
       if (reg_[0] != 0) {
-        pc_ = static_cast<std::size_t>(it->second);
+        pc_ = ins.target;
+        ++fstats_.retired;
       } else {
         next();
       }
       break;
     }
+    // Vectoriales: el cómputo por lane lo hacen los kernels SIMD del host
+    case OpCode::VLOAD: {
+      // Un acceso a caché por línea tocada: alineado es uno solo; si el
+      // puntero no está alineado se parte en dos y, como REDUCE, se reanuda
+      // en vload_off_ si el 1ro queda esperando al bus
+      const Addr base = static_cast<Addr>(reg_[ins.ra]);
+      const std::size_t lanes = (reg_[0] != 0 && reg_[0] < vl_) ? reg_[0] : vl_;
+      const std::size_t bytes = lanes * cfg::kWordBytes;
+      const std::size_t lb    = cache_.line_bytes();
+      auto *dst = reinterpret_cast<std::uint8_t *>(vreg_[ins.rd]);
+      while (vload_off_ < bytes) {
+        const Addr a = base + vload_off_;
+        const std::size_t n = std::min(bytes - vload_off_, lb - static_cast<std::size_t>(a % lb));
+        cache_access(AccessType::Load, a, n, dst + vload_off_);
+        if (cache_.stalled()) return;
+        vload_off_ += n;
+      }
+      vload_off_ = 0;
+      std::fill(vreg_[ins.rd] + lanes, vreg_[ins.rd] + vecops::kMaxLanes, 0.0);
+      LOGF(cfg::kLogPE, "[PE{}] VLOAD V{}, [R{}] @0x{x} lanes={}", id_, ins.rd, ins.ra, base, lanes);
+      vnext();
+      break;
+    }
+    case OpCode::VFMA: {
+      vecops::kernels().fma(vreg_[ins.rd], vreg_[ins.ra], vreg_[ins.rb], vl_);
+      LOGF(cfg::kLogPE, "[PE{}] VFMA V{}, V{}, V{}", id_, ins.rd, ins.ra, ins.rb);
+      vnext();
+      break;
+    }
+    case OpCode::VREDUCE: {
+      const double sum = vecops::kernels().hsum(vreg_[ins.ra], vl_);
+      reg_[ins.rd] = from_double(sum);
+      LOGF(cfg::kLogPE, "[PE{}] VREDUCE R{}, V{} -> {f}", id_, ins.rd, ins.ra, sum);
+      vnext();
+      break;
+    }
+    case OpCode::VZERO: {
+      std::fill(vreg_[ins.rd], vreg_[ins.rd] + vecops::kMaxLanes, 0.0);
+      LOGF(cfg::kLogPE, "[PE{}] VZERO V{}", id_, ins.rd);
+      vnext();
+      break;
+    }
+    case OpCode::VINC: {
+      reg_[ins.rd] += vl_ * cfg::kWordBytes;
+      LOGF(cfg::kLogPE, "[PE{}] VINC R{} (+{})", id_, ins.rd, vl_ * cfg::kWordBytes);
+      vnext();
+      break;
+    }
+    case OpCode::VDEC: {
+      reg_[ins.rd] = reg_[ins.rd] > vl_ ? reg_[ins.rd] - vl_ : 0;
+      LOGF(cfg::kLogPE, "[PE{}] VDEC R{} (-{})", id_, ins.rd, vl_);
+      vnext();
+      break;
+    }
+    // Superinstrucciones (sólo en blocks_): mismo resultado que el par por
+    // separado; FMULADD redondea producto y suma por separado (no es fma()).
+    case OpCode::FMULADD: {
+      const int rd2 = ins.target & 0xFF, ra2 = (ins.target >> 8) & 0xFF, rb2 = (ins.target >> 16) & 0xFF;
+      reg_[ins.rd] = from_double(as_double(reg_[ins.ra]) * as_double(reg_[ins.rb]));
+      reg_[rd2]    = from_double(as_double(reg_[ra2]) + as_double(reg_[rb2]));
+      LOGF(cfg::kLogPE, "[PE{}] FMUL R{}, R{}, R{} + FADD {regs}", id_, ins.rd, ins.ra, ins.rb, ins.target);
+      pc_ += 2;
+      fstats_.retired += 2;
+      ++fstats_.fmuladd;
+      owed_ = 1;
+      break;
+    }
+    case OpCode::DECJNZ: {
+      reg_[ins.rd] -= 1;
+      LOGF(cfg::kLogPE, "[PE{}] DEC R{} + JNZ", id_, ins.rd);
+      pc_ = reg_[0] != 0 ? ins.target : pc_ + 2;
+      fstats_.retired += 2;
+      ++fstats_.decjnz;
+      owed_ = 1;
+      break;
+    }
     }
   }
 
+  // ===== Modo traza =====
+  bool Processor::next_access(Access &out)
+  {
+    if (reader_) return reader_->next(out);
+    if (pc_trace_ >= trace_.size()) return false;
+    out = trace_[pc_trace_++];
+    return true;
+  }
+
+  // Un tick de traza: primero los ticks de cómputo ('gap') y después el acceso.
+  // El modelo es de palabras de 64 bits: size 0 o > 8 cuenta como 8 y la
+  // dirección se alinea al tamaño (nunca cruza de línea).
+  void Processor::exec_access()
+  {
+    if (!cur_) {
+      Access a{};
+      if (trace_eof_ || !next_access(a)) { trace_eof_ = true; return; }
+      a.size = (a.size == 0 || a.size > sizeof(Word)) ? sizeof(Word) : std::bit_ceil(a.size);
+      a.addr &= ~static_cast<Addr>(a.size - 1);
+      cur_      = a;
+      gap_left_ = a.gap;
+    }
+    if (gap_left_) { --gap_left_; return; }
+
+    // Valor sintético para los stores: la traza sólo trae direcciones
+    Word v = cur_->type == AccessType::Store ? static_cast<Word>(cur_->addr) : 0;
+    cache_access(cur_->type, cur_->addr, cur_->size, &v);
+    if (cache_.stalled()) return;  // reintenta el mismo acceso el próximo tick
+    cur_.reset();
+  }
+
   void Processor::step()
   {
     if (mode_ == ExecMode::ISA) {
+      if (owed_) { --owed_; return; }  // tick de la 2da instrucción de un par
       exec_one();
     } else {
-      // Traza (placeholder simple)
-      if (pc_trace_ < trace_.size()) {
-        // aquí iría la simulación de un acceso
-        pc_trace_++;
-      }
+      exec_access();
     }
   }
 
   bool Processor::is_done() const
   {
     if (mode_ == ExecMode::ISA) {
-      return pc_ >= prog_.code.size();
+      return pc_ >= prog_.code.size() && owed_ == 0;
     }
-    return true; // modo traza: por ahora asumimos fin
-  }
-
-  const std::unordered_map<std::string, int> &Processor::labels_map()
-  {
-    return get_labels_singleton();
+    if (cur_) return false;
+    return reader_ ? trace_eof_ : pc_trace_ >= trace_.size();
   }
 
 } // namespace sim
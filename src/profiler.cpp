@@ -0,0 +1,139 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sim
+{
+
+namespace {
+
+std::atomic<std::uint64_t> g_gen{0};
+
+#if defined(__linux__)
+// Contador de usuario del hilo que llama (pid = 0, cualquier CPU). Con
+// group_fd = -1 abre un líder; si no, se suma al grupo de ese líder y el
+// kernel los programa (y multiplexa) juntos.
+int open_counter(std::uint64_t config, int group_fd) {
+  perf_event_attr a{};
+  a.size           = sizeof a;
+  a.type           = PERF_TYPE_HARDWARE;
+  a.config         = config;
+  a.exclude_kernel = 1;
+  a.exclude_hv     = 1;
+  a.read_format    = PERF_FORMAT_GROUP;
+  return static_cast<int>(syscall(SYS_perf_event_open, &a, 0, -1, group_fd, 0));
+}
+
+// Lectura del grupo por el líder: { nr, valor[nr] } en orden de alta
+struct GroupRead {
+  std::uint64_t nr = 0;
+  std::uint64_t v[2] = {};
+};
+
+GroupRead read_group(int leader) {
+  GroupRead g;
+  if (leader < 0 || ::read(leader, &g, sizeof g) < static_cast<ssize_t>(2 * sizeof(std::uint64_t)))
+    return {};
+  return g;
+}
+#endif
+
+} // namespace
+
+Profiler::Profiler(ProfileMode mode)
+    : mode_(mode), gen_(g_gen.fetch_add(1, std::memory_order_relaxed) + 1),
+      tsc0_(stamp()), wall0_(std::chrono::steady_clock::now()) {}
+
+Profiler::~Profiler() {
+#if defined(__linux__)
+  for (auto& s : slots_) {
+    if (s->fd_cycles >= 0) ::close(s->fd_cycles);
+    if (s->fd_misses >= 0) ::close(s->fd_misses);
+  }
+#endif
+}
+
+Profiler::Slot& Profiler::add_slot() {
+  auto s = std::make_unique<Slot>();
+  if (mode_ == ProfileMode::Perf) open_perf(*s);
+  std::scoped_lock lk(m_);
+  slots_.push_back(std::move(s));
+  t_slot_ = slots_.back().get();
+  t_gen_  = gen_;
+  return *t_slot_;
+}
+
+void Profiler::open_perf(Slot& s) {
+#if defined(__linux__)
+  s.fd_cycles = open_counter(PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (s.fd_cycles >= 0) s.fd_misses = open_counter(PERF_COUNT_HW_CACHE_MISSES, s.fd_cycles);
+  if (s.fd_cycles < 0 || s.fd_misses < 0) {
+    std::scoped_lock lk(m_);
+    if (!perf_errno_) perf_errno_ = errno ? errno : ENOSYS;
+  }
+#else
+  (void)s;
+  perf_errno_ = ENOSYS;
+#endif
+}
+
+void Profiler::report(std::ostream& os, std::uint64_t instr, const char* unit) const {
+  // TSC -> segundos con la pendiente medida en este run (no depende de /proc)
+  const double ns  = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - wall0_).count();
+  const double tpn = ns > 0 ? static_cast<double>(stamp() - tsc0_) / ns : 1.0;  // ticks de TSC por ns
+  auto secs = [&](std::uint64_t t) { return static_cast<double>(t) / tpn * 1e-9; };
+
+  const std::uint64_t run = pe_phase_ + bus_phase_;
+  const std::uint64_t all = run + between_;
+  auto pct = [&](std::uint64_t t) { return all ? 100.0 * static_cast<double>(t) / static_cast<double>(all) : 0.0; };
+
+  const auto flags = os.flags();
+  const auto prec  = os.precision();
+  os << std::fixed << std::setprecision(6)
+     << "[Prof] host=" << secs(all) << " s | ticks=" << ticks_
+     << " | fase PE=" << secs(pe_phase_) << " s (" << std::setprecision(1) << pct(pe_phase_) << "%)"
+     << std::setprecision(6) << " | fase bus=" << secs(bus_phase_) << " s ("
+     << std::setprecision(1) << pct(bus_phase_) << "%)"
+     << std::setprecision(6) << " | entre ticks=" << secs(between_) << " s ("
+     << std::setprecision(1) << pct(between_) << "%)"
+     << std::setprecision(2) << " | TSC=" << tpn << " GHz\n";
+
+  const double host = secs(all);
+  os << std::setprecision(0) << "[Prof] " << unit << "=" << instr
+     << " | " << unit << "/s=" << (host > 0 ? static_cast<double>(instr) / host : 0.0) << "\n";
+
+  std::scoped_lock lk(m_);
+  for (std::size_t i = 0; i < slots_.size(); ++i) {
+    const Slot& s = *slots_[i];
+    const std::uint64_t busy = s.work[PE] + s.work[Bus];
+    const std::uint64_t wait = run > busy ? run - busy : 0;
+    os << std::setprecision(6) << "[Prof] hilo " << i
+       << ": PE=" << secs(s.work[PE]) << " s | bus=" << secs(s.work[Bus]) << " s | espera="
+       << secs(wait) << " s (" << std::setprecision(1)
+       << (run ? 100.0 * static_cast<double>(wait) / static_cast<double>(run) : 0.0) << "%)";
+#if defined(__linux__)
+    if (s.fd_cycles >= 0) {
+      const GroupRead g = read_group(s.fd_cycles);  // cycles y cache-misses del mismo intervalo
+      if (g.nr >= 1) os << " | cycles=" << g.v[0];
+      if (g.nr >= 2 && s.fd_misses >= 0) os << " | cache-misses=" << g.v[1];
+    }
+#endif
+    os << "\n";
+  }
+  if (perf_errno_)
+    os << "[Prof] perf_event_open no disponible (" << std::strerror(perf_errno_)
+       << "): sólo TSC (sin PMU en el host o perf_event_paranoid alto)\n";
+  os.flags(flags);
+  os.precision(prec);
+}
+
+} // namespace sim
@@ -0,0 +1,154 @@
+#include "replacement.hpp"
+#include <algorithm>
+
+namespace sim
+{
+
+Replacement::Replacement(ReplPolicy policy, std::size_t sets, std::size_t ways,
+                         Arena& arena, std::uint64_t seed)
+    : policy_(policy), sets_(sets), ways_(ways),
+      rng_(seed * 0x9E3779B97F4A7C15ull + 1)
+{
+  switch (policy_) {
+    case ReplPolicy::LRU:
+    case ReplPolicy::FIFO:
+      stamp_ = arena.make_array<std::uint64_t>(sets_ * ways_);
+      break;
+    case ReplPolicy::PLRU:
+      tree_ = arena.make_array<std::uint64_t>(sets_);
+      break;
+    case ReplPolicy::SRRIP:
+    case ReplPolicy::BRRIP:
+    case ReplPolicy::DRRIP:
+      rrpv_ = arena.make_array<std::uint8_t>(sets_ * ways_);
+      std::fill_n(rrpv_, sets_ * ways_, kRrpvMax);
+      // ~32 pares de líderes como en el paper; con pocos sets, al menos 1 de cada 4
+      duel_period_ = std::max<std::size_t>(4, sets_ / 32);
+      break;
+    case ReplPolicy::Random:
+      break;
+  }
+}
+
+std::uint64_t Replacement::next_random() {
+  // xorshift64: barato y determinista por caché
+  rng_ ^= rng_ << 13;
+  rng_ ^= rng_ >> 7;
+  rng_ ^= rng_ << 17;
+  return rng_;
+}
+
+void Replacement::on_hit(std::size_t set, std::size_t way) {
+  switch (policy_) {
+    case ReplPolicy::LRU:   stamp_[slot(set, way)] = ++clock_; break;
+    case ReplPolicy::PLRU:  plru_touch(set, way);              break;
+    case ReplPolicy::SRRIP:
+    case ReplPolicy::BRRIP:
+    case ReplPolicy::DRRIP: rrpv_[slot(set, way)] = 0;         break;  // hit priority
+    default: break;  // FIFO/Random no miran los hits
+  }
+}
+
+void Replacement::on_fill(std::size_t set, std::size_t way) {
+  switch (policy_) {
+    case ReplPolicy::LRU:
+    case ReplPolicy::FIFO:
+      stamp_[slot(set, way)] = ++clock_;
+      break;
+    case ReplPolicy::PLRU:
+      plru_touch(set, way);
+      break;
+    case ReplPolicy::SRRIP:
+      rrpv_[slot(set, way)] = kRrpvMax - 1;
+      break;
+    case ReplPolicy::BRRIP:
+    case ReplPolicy::DRRIP: {
+      const bool brrip = policy_ == ReplPolicy::BRRIP || brrip_for(set);
+      std::uint8_t v = kRrpvMax - 1;
+      if (brrip && next_random() % kBrripOdds != 0) { v = kRrpvMax; ++distant_inserts_; }
+      rrpv_[slot(set, way)] = v;
+      break;
+    }
+    case ReplPolicy::Random:
+      break;
+  }
+}
+
+std::size_t Replacement::victim(std::size_t set) {
+  switch (policy_) {
+    case ReplPolicy::LRU:
+    case ReplPolicy::FIFO: {
+      const std::uint64_t* st = stamp_ + slot(set, 0);
+      return static_cast<std::size_t>(std::min_element(st, st + ways_) - st);
+    }
+    case ReplPolicy::PLRU:
+      return plru_victim(set);
+    case ReplPolicy::Random:
+      return static_cast<std::size_t>(next_random() % ways_);
+    case ReplPolicy::SRRIP:
+    case ReplPolicy::BRRIP:
+      return rrip_victim(set);
+    case ReplPolicy::DRRIP: {
+      // Un miss (hay víctima) en un líder vota en contra de su política
+      const std::size_t r = set % duel_period_;
+      if (r == 0 && psel_ < kPselMax) ++psel_;   // falló SRRIP -> hacia BRRIP
+      if (r == 1 && psel_ > 0)        --psel_;   // falló BRRIP -> hacia SRRIP
+      return rrip_victim(set);
+    }
+  }
+  return 0;
+}
+
+bool Replacement::brrip_for(std::size_t set) {
+  const std::size_t r = set % duel_period_;
+  if (r == 0) return false;             // líder SRRIP
+  if (r == 1) return true;              // líder BRRIP
+  return followers_use_brrip();         // followers: la que va ganando
+}
+
+std::size_t Replacement::rrip_victim(std::size_t set) {
+  std::uint8_t* rr = rrpv_ + slot(set, 0);
+  while (true) {
+    for (std::size_t w = 0; w < ways_; ++w)
+      if (rr[w] >= kRrpvMax) return w;
+    // Nadie "distante": envejecer el set y volver a buscar
+    for (std::size_t w = 0; w < ways_; ++w) ++rr[w];
+  }
+}
+
+// Tree-PLRU: nodo i (desde 1) tiene hijos 2i y 2i+1; el bit indica hacia qué
+// lado está el menos recientemente usado (0 = izquierda, 1 = derecha).
+std::size_t Replacement::plru_victim(std::size_t set) const {
+  if (ways_ == 1) return 0;
+  const std::uint64_t bits = tree_[set];
+  std::size_t node = 1;
+  while (node < ways_) node = 2 * node + ((bits >> node) & 1u);
+  return node - ways_;
+}
+
+void Replacement::plru_touch(std::size_t set, std::size_t way) {
+  if (ways_ == 1) return;
+  std::uint64_t bits = tree_[set];
+  // Desde la hoja a la raíz: cada padre apunta al lado contrario del usado
+  for (std::size_t node = way + ways_; node > 1; node /= 2) {
+    const std::size_t parent = node / 2;
+    if (node & 1u) bits &= ~(std::uint64_t{1} << parent);  // usado derecha -> LRU izquierda
+    else           bits |=  (std::uint64_t{1} << parent);  // usado izquierda -> LRU derecha
+  }
+  tree_[set] = bits;
+}
+
+const char* to_string(ReplPolicy p) {
+  switch (p) {
+    case ReplPolicy::LRU:    return "lru";
+    case ReplPolicy::PLRU:   return "plru";
+    case ReplPolicy::FIFO:   return "fifo";
+    case ReplPolicy::Random: return "random";
+    case ReplPolicy::SRRIP:  return "srrip";
+    case ReplPolicy::BRRIP:  return "brrip";
+    case ReplPolicy::DRRIP:  return "drrip";
+  }
+  return "?";
+}
+
+} // namespace sim
@@ -0,0 +1,131 @@
+#include "sampler.hpp"
+#include "bus.hpp"
+#include "cache.hpp"
+#include <charconv>
+#include <stdexcept>
+
+namespace sim
+{
+
+namespace {
+
+void put(std::string& out, std::uint64_t v) {
+  char num[24];
+  auto res = std::to_chars(num, num + sizeof num, v);
+  out.append(num, res.ptr);
+}
+
+// Campos por PE: nombre y delta del intervalo (mismo orden en CSV y JSON)
+struct Field {
+  const char*   name;
+  std::uint64_t Metrics::*m;
+};
+constexpr Field kFields[] = {
+  {"loads",         &Metrics::loads},
+  {"stores",        &Metrics::stores},
+  {"hits",          &Metrics::hits},
+  {"misses",        &Metrics::misses},
+  {"invalidations", &Metrics::invalidations},
+  {"flushes",       &Metrics::flushes},
+  {"bus_bytes",     &Metrics::bus_bytes},
+  {"e_to_s",        &Metrics::trans_e_to_s},
+  {"s_to_m",        &Metrics::trans_s_to_m},
+  {"e_to_m",        &Metrics::trans_e_to_m},
+  {"m_to_s",        &Metrics::trans_m_to_s},
+  {"x_to_i",        &Metrics::trans_x_to_i},
+  {"stall_cycles",  &Metrics::stall_cycles},
+};
+
+} // namespace
+
+Sampler::Sampler(const std::string& path, SampleFormat fmt, std::size_t every, std::size_t num_pes)
+    : path_(path), out_(path, std::ios::binary | std::ios::trunc), fmt_(fmt), every_(every), next_(every),
+      prev_(num_pes)
+{
+  if (!out_) throw std::runtime_error("No se puede crear el archivo de muestras: " + path);
+  if (every_ == 0) throw std::runtime_error("sample-every debe ser > 0");
+  buf_.reserve(kFlushBytes + 4096);
+  write_header();
+}
+
+Sampler::~Sampler() {
+  try { close(); } catch (...) {}
+}
+
+void Sampler::write_header() {
+  if (fmt_ != SampleFormat::Csv) return;
+  buf_ += "tick,dt,pe";
+  for (const auto& f : kFields) { buf_ += ','; buf_ += f.name; }
+  buf_ += ",bus_total_bytes,bus_rd,bus_rdx,bus_upgr,bus_flushes\n";
+}
+
+void Sampler::sample(std::uint64_t tick, const std::vector<std::unique_ptr<Cache>>& caches, const Bus& bus) {
+  const std::uint64_t dt = tick - last_tick_;
+  const BusSnap cur_bus{bus.bytes(), bus.count_cmd(BusCmd::BusRd), bus.count_cmd(BusCmd::BusRdX),
+                        bus.count_cmd(BusCmd::BusUpgr), bus.flushes()};
+  const BusSnap d{cur_bus.bytes - prev_bus_.bytes, cur_bus.rd - prev_bus_.rd,
+                  cur_bus.rdx - prev_bus_.rdx, cur_bus.upgr - prev_bus_.upgr,
+                  cur_bus.flushes - prev_bus_.flushes};
+
+  if (fmt_ == SampleFormat::Jsonl) {
+    buf_ += "{\"tick\":";        put(buf_, tick);
+    buf_ += ",\"dt\":";          put(buf_, dt);
+    buf_ += ",\"bus\":{\"bytes\":"; put(buf_, d.bytes);
+    buf_ += ",\"rd\":";          put(buf_, d.rd);
+    buf_ += ",\"rdx\":";         put(buf_, d.rdx);
+    buf_ += ",\"upgr\":";        put(buf_, d.upgr);
+    buf_ += ",\"flushes\":";     put(buf_, d.flushes);
+    buf_ += "},\"pe\":[";
+  }
+
+  for (std::size_t pe = 0; pe < caches.size() && pe < prev_.size(); ++pe) {
+    const Metrics& m = caches[pe]->metrics();
+    Metrics&       p = prev_[pe];
+    if (fmt_ == SampleFormat::Csv) {
+      put(buf_, tick); buf_ += ','; put(buf_, dt); buf_ += ','; put(buf_, pe);
+      for (const auto& f : kFields) { buf_ += ','; put(buf_, m.*f.m - p.*f.m); }
+      buf_ += ','; put(buf_, d.bytes);
+      buf_ += ','; put(buf_, d.rd);
+      buf_ += ','; put(buf_, d.rdx);
+      buf_ += ','; put(buf_, d.upgr);
+      buf_ += ','; put(buf_, d.flushes);
+      buf_ += '\n';
+    } else {
+      if (pe) buf_ += ',';
+      buf_ += "{\"pe\":"; put(buf_, pe);
+      for (const auto& f : kFields) {
+        buf_ += ",\""; buf_ += f.name; buf_ += "\":"; put(buf_, m.*f.m - p.*f.m);
+      }
+      buf_ += '}';
+    }
+    p = m;
+  }
+  if (fmt_ == SampleFormat::Jsonl) buf_ += "]}\n";
+
+  prev_bus_  = cur_bus;
+  last_tick_ = tick;
+  next_      = tick + every_;
+  ++samples_;
+  if (buf_.size() >= kFlushBytes) flush_buf();
+}
+
+void Sampler::finish(std::uint64_t tick, const std::vector<std::unique_ptr<Cache>>& caches, const Bus& bus) {
+  if (tick > last_tick_) sample(tick, caches, bus);
+  close();
+}
+
+void Sampler::flush_buf() {
+  if (buf_.empty() || !out_.is_open()) return;
+  out_.write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+  bytes_written_ += buf_.size();
+  buf_.clear();
+}
+
+void Sampler::close() {
+  if (!out_.is_open()) return;
+  flush_buf();
+  out_.close();
+  if (!out_) throw std::runtime_error("Error escribiendo el archivo de muestras: " + path_);
+}
+
+} // namespace sim
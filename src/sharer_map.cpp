@@ -0,0 +1,85 @@
+#include "sharer_map.hpp"
+
+namespace sim
+{
+
+// ---------- SharerSet ----------
+bool SharerSet::none() const {
+  for (auto w : w_) if (w) return false;
+  return true;
+}
+
+std::size_t SharerSet::count() const {
+  std::size_t n = 0;
+  for (auto w : w_) n += static_cast<std::size_t>(__builtin_popcountll(w));
+  return n;
+}
+
+void SharerSet::keep_only(PEId pe) {
+  const bool had = test(pe);
+  for (auto& w : w_) w = 0;
+  if (had) set(pe);
+}
+
+// ---------- SharerMap ----------
+SharerMap::SharerMap(const SimConfig& cfg)
+    : line_bytes_(cfg.line_bytes), num_pes_(cfg.num_pes) {}
+
+void SharerMap::add(Addr line_addr, PEId pe) {
+  const Addr idx = line_index(line_addr);
+  auto& st = stripe_of(idx);
+  std::scoped_lock lk(st.m);
+  auto [it, inserted] = st.map.try_emplace(idx);
+  if (inserted) it->second.sharers = SharerSet(num_pes_);
+  it->second.sharers.set(pe);
+}
+
+void SharerMap::remove(Addr line_addr, PEId pe) {
+  const Addr idx = line_index(line_addr);
+  auto& st = stripe_of(idx);
+  std::scoped_lock lk(st.m);
+  auto it = st.map.find(idx);
+  if (it == st.map.end()) return;
+  it->second.sharers.reset(pe);
+  if (it->second.owner == static_cast<int>(pe)) it->second.owner = -1;
+  if (it->second.sharers.none()) st.map.erase(it); // nadie la tiene: no se guarda
+}
+
+void SharerMap::keep_only(Addr line_addr, PEId pe) {
+  const Addr idx = line_index(line_addr);
+  auto& st = stripe_of(idx);
+  std::scoped_lock lk(st.m);
+  auto it = st.map.find(idx);
+  if (it == st.map.end()) return;
+  it->second.sharers.keep_only(pe);
+  if (it->second.sharers.none()) { st.map.erase(it); return; } // el que escribe ya la evictó
+  it->second.owner = static_cast<int>(pe);
+}
+
+void SharerMap::set_owner(Addr line_addr, int pe) {
+  const Addr idx = line_index(line_addr);
+  auto& st = stripe_of(idx);
+  std::scoped_lock lk(st.m);
+  auto it = st.map.find(idx);
+  if (it != st.map.end()) it->second.owner = pe;
+}
+
+SharerMap::Line SharerMap::get(Addr line_addr) const {
+  const Addr idx = line_index(line_addr);
+  const auto& st = stripe_of(idx);
+  std::scoped_lock lk(st.m);
+  auto it = st.map.find(idx);
+  if (it == st.map.end()) return {SharerSet(num_pes_), -1};
+  return it->second;
+}
+
+std::size_t SharerMap::size() const {
+  std::size_t n = 0;
+  for (const auto& st : stripes_) {
+    std::scoped_lock lk(st.m);
+    n += st.map.size();
+  }
+  return n;
+}
+
+} // namespace sim
@@ -0,0 +1,311 @@
+#include "sim_config.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace sim
+{
+// Parser de configuración: una sola tabla de claves que comparten CLI y archivo.
+
+namespace {
+
+std::string trim(const std::string& s) {
+  const auto i = s.find_first_not_of(" \t\r\n");
+  if (i == std::string::npos) return {};
+  const auto j = s.find_last_not_of(" \t\r\n");
+  return s.substr(i, j - i + 1);
+}
+
+// Entero sin signo, decimal o 0xHEX (igual que MOVI en el ensamblador)
+std::size_t parse_size(const std::string& key, const std::string& v) {
+  try {
+    std::size_t pos = 0;
+    unsigned long long x = 0;
+    if (v.size() > 2 && v[0] == '0' && (v[1] == 'x' || v[1] == 'X'))
+      x = std::stoull(v, &pos, 16);
+    else
+      x = std::stoull(v, &pos, 10);
+    if (pos != v.size()) throw std::invalid_argument(v);
+    return static_cast<std::size_t>(x);
+  } catch (...) {
+    throw std::runtime_error("Valor inválido para '" + key + "': " + v);
+  }
+}
+
+struct KeyDef {
+  const char* name;
+  std::size_t SimConfig::* field;
+};
+
+// Claves numéricas soportadas (nombre en CLI/archivo -> campo)
+constexpr KeyDef kKeys[] = {
+  {"pes",        &SimConfig::num_pes},
+  {"mem-words",  &SimConfig::mem_words},
+  {"ways",       &SimConfig::cache_ways},
+  {"lines",      &SimConfig::cache_lines},
+  {"line-bytes", &SimConfig::line_bytes},
+  {"bus-ops",    &SimConfig::bus_ops_per_cycle},
+  {"dot-n",      &SimConfig::dot_n},
+  {"spin",       &SimConfig::spin_limit},
+  {"workers",    &SimConfig::workers},
+  {"bus-width",  &SimConfig::bus_width},
+  {"bus-outstanding", &SimConfig::bus_outstanding},
+  {"lat-rd",     &SimConfig::lat_rd},
+  {"lat-rdx",    &SimConfig::lat_rdx},
+  {"lat-upgr",   &SimConfig::lat_upgr},
+  {"lat-flush",  &SimConfig::lat_flush},
+  {"bus-banks",  &SimConfig::bus_banks},
+  {"bus-threads", &SimConfig::bus_threads},
+  {"sample-every", &SimConfig::sample_every},
+};
+
+// Claves con valor simbólico (se resuelven a mano en SimConfig::set)
+constexpr const char* kEnumKeys[] = {"sync", "engine", "coherence", "snoop-filter", "bus-model",
+                                    "tag-match", "repl", "write-policy", "protocol", "fuse",
+                                    "mem-image", "snapshot", "dump-mem", "trace", "record",
+                                    "sample", "sample-format", "profile"};
+
+bool is_pow2(std::size_t x) { return x != 0 && (x & (x - 1)) == 0; }
+
+bool known_key(const std::string& key) {
+  for (const auto& k : kKeys)     if (key == k.name) return true;
+  for (const auto* k : kEnumKeys) if (key == k)      return true;
+  return key == "config";
+}
+
+bool parse_bool(const std::string& key, const std::string& v) {
+  if (v == "on"  || v == "1" || v == "true")  return true;
+  if (v == "off" || v == "0" || v == "false") return false;
+  throw std::runtime_error("Valor inválido para '" + key + "' (on|off): " + v);
+}
+
+SyncMode parse_sync(const std::string& v) {
+  if (v == "barrier") return SyncMode::Barrier;
+  if (v == "condvar") return SyncMode::CondVar;
+  throw std::runtime_error("Valor inválido para 'sync' (barrier|condvar): " + v);
+}
+
+Engine parse_engine(const std::string& v) {
+  if (v == "threads") return Engine::Threads;
+  if (v == "pool")    return Engine::Pool;
+  if (v == "inline")  return Engine::Inline;
+  throw std::runtime_error("Valor inválido para 'engine' (threads|pool|inline): " + v);
+}
+
+CoherenceMode parse_coherence(const std::string& v) {
+  if (v == "snoop")     return CoherenceMode::Snoop;
+  if (v == "directory") return CoherenceMode::Directory;
+  throw std::runtime_error("Valor inválido para 'coherence' (snoop|directory): " + v);
+}
+
+BusModel parse_bus_model(const std::string& v) {
+  if (v == "atomic") return BusModel::Atomic;
+  if (v == "split")  return BusModel::Split;
+  throw std::runtime_error("Valor inválido para 'bus-model' (atomic|split): " + v);
+}
+
+TagMatch parse_tag_match(const std::string& v) {
+  if (v == "auto")   return TagMatch::Auto;
+  if (v == "scalar") return TagMatch::Scalar;
+  if (v == "sse41")  return TagMatch::Sse41;
+  if (v == "avx2")   return TagMatch::Avx2;
+  throw std::runtime_error("Valor inválido para 'tag-match' (auto|scalar|sse41|avx2): " + v);
+}
+
+ReplPolicy parse_repl(const std::string& v) {
+  for (ReplPolicy p : {ReplPolicy::LRU, ReplPolicy::PLRU, ReplPolicy::FIFO, ReplPolicy::Random,
+                       ReplPolicy::SRRIP, ReplPolicy::BRRIP, ReplPolicy::DRRIP})
+    if (v == to_string(p)) return p;
+  throw std::runtime_error("Valor inválido para 'repl' (lru|plru|fifo|random|srrip|brrip|drrip): " + v);
+}
+
+WritePolicy parse_write_policy(const std::string& v) {
+  if (v == "through") return WritePolicy::WriteThrough;
+  if (v == "back")    return WritePolicy::WriteBack;
+  throw std::runtime_error("Valor inválido para 'write-policy' (through|back): " + v);
+}
+
+Protocol parse_protocol(const std::string& v) {
+  if (v == "mesi")  return Protocol::MESI;
+  if (v == "moesi") return Protocol::MOESI;
+  if (v == "mesif") return Protocol::MESIF;
+  throw std::runtime_error("Valor inválido para 'protocol' (mesi|moesi|mesif): " + v);
+}
+
+SampleFormat parse_sample_format(const std::string& v) {
+  if (v == "csv")   return SampleFormat::Csv;
+  if (v == "jsonl") return SampleFormat::Jsonl;
+  throw std::runtime_error("Valor inválido para 'sample-format' (csv|jsonl): " + v);
+}
+
+ProfileMode parse_profile(const std::string& v) {
+  if (v == "off")  return ProfileMode::Off;
+  if (v == "tsc")  return ProfileMode::Tsc;
+  if (v == "perf") return ProfileMode::Perf;
+  throw std::runtime_error("Valor inválido para 'profile' (off|tsc|perf): " + v);
+}
+
+// --dump-mem: all | off | LO:HI (bytes, [LO, HI), decimal o 0xHEX)
+void parse_dump_mem(SimConfig& c, const std::string& v) {
+  if (v == "all") { c.dump_mem = true;  c.dump_mem_lo = 0; c.dump_mem_hi = ~std::uint64_t{0}; return; }
+  if (v == "off") { c.dump_mem = false; return; }
+  const auto colon = v.find(':');
+  if (colon == std::string::npos)
+    throw std::runtime_error("Valor inválido para 'dump-mem' (all|off|LO:HI): " + v);
+  c.dump_mem    = true;
+  c.dump_mem_lo = parse_size("dump-mem", v.substr(0, colon));
+  c.dump_mem_hi = parse_size("dump-mem", v.substr(colon + 1));
+  if (c.dump_mem_hi <= c.dump_mem_lo)
+    throw std::runtime_error("dump-mem: HI debe ser > LO: " + v);
+}
+
+} // namespace
+
+void SimConfig::set(const std::string& key, const std::string& value) {
+  if (key == "sync")      { sync      = parse_sync(value);      return; }
+  if (key == "engine")    { engine    = parse_engine(value);    return; }
+  if (key == "coherence") { coherence = parse_coherence(value); return; }
+  if (key == "snoop-filter") { snoop_filter = parse_bool(key, value); return; }
+  if (key == "fuse")         { fuse         = parse_bool(key, value); return; }
+  if (key == "bus-model")    { bus_model    = parse_bus_model(value);  return; }
+  if (key == "tag-match")    { tag_match    = parse_tag_match(value);  return; }
+  if (key == "repl")         { repl         = parse_repl(value);       return; }
+  if (key == "write-policy") { write_policy = parse_write_policy(value); return; }
+  if (key == "protocol")     { protocol     = parse_protocol(value);     return; }
+  if (key == "mem-image")    { mem_image    = value;                     return; }
+  if (key == "snapshot")     { snapshot     = value;                     return; }
+  if (key == "dump-mem")     { parse_dump_mem(*this, value);             return; }
+  if (key == "trace")        { trace        = value;                     return; }
+  if (key == "record")       { record       = value;                     return; }
+  if (key == "sample")       { sample       = value;                     return; }
+  if (key == "sample-format") { sample_format = parse_sample_format(value); return; }
+  if (key == "profile")      { profile      = parse_profile(value);      return; }
+  for (const auto& k : kKeys) {
+    if (key == k.name) {
+      this->*(k.field) = parse_size(key, value);
+      return;
+    }
+  }
+  throw std::runtime_error("Clave de configuración desconocida: " + key);
+}
+
+void SimConfig::load_file(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("No se puede abrir config: " + path);
+
+  std::string line;
+  std::size_t lineno = 0;
+  while (std::getline(in, line)) {
+    ++lineno;
+    auto pos = line.find_first_of(";#");
+    if (pos != std::string::npos) line.resize(pos);
+    line = trim(line);
+    if (line.empty()) continue;
+
+    auto eq = line.find('=');
+    if (eq == std::string::npos)
+      throw std::runtime_error(path + ":" + std::to_string(lineno) + ": se esperaba 'clave = valor'");
+    set(trim(line.substr(0, eq)), trim(line.substr(eq + 1)));
+  }
+}
+
+std::vector<std::string> SimConfig::parse_args(int argc, char** argv) {
+  std::vector<std::string> rest;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a.rfind("--", 0) != 0) { rest.push_back(a); continue; }
+
+    // --clave=valor o --clave valor
+    std::string key = a.substr(2), value;
+    bool has_value = false;
+    if (auto eq = key.find('='); eq != std::string::npos) {
+      value = key.substr(eq + 1);
+      key.resize(eq);
+      has_value = true;
+    }
+
+    if (!known_key(key)) { rest.push_back(a); continue; }
+
+    if (!has_value) {
+      if (i + 1 >= argc) throw std::runtime_error("Falta valor para --" + key);
+      value = argv[++i];
+    }
+    if (key == "config") load_file(value);
+    else                 set(key, value);
+  }
+  return rest;
+}
+
+void SimConfig::validate() const {
+  if (num_pes == 0)
+    throw std::runtime_error("pes debe ser >= 1");
+  if (mem_words == 0 || mem_words > (std::size_t{1} << 40))
+    throw std::runtime_error("mem-words debe estar entre 1 y 2^40 (8 TiB)");
+  if (!is_pow2(line_bytes) || line_bytes < cfg::kWordBytes)
+    throw std::runtime_error("line-bytes debe ser potencia de 2 y >= " + std::to_string(cfg::kWordBytes));
+  if (line_bytes > 4096)  // Memory::kPageBytes: una línea nunca cruza página
+    throw std::runtime_error("line-bytes debe ser <= 4096");
+  if (cache_ways == 0 || cache_lines == 0 || cache_lines % cache_ways != 0)
+    throw std::runtime_error("lines debe ser múltiplo (no nulo) de ways");
+  if (repl == ReplPolicy::PLRU && (!is_pow2(cache_ways) || cache_ways > 64))
+    throw std::runtime_error("repl plru requiere ways potencia de 2 y <= 64");
+  if (protocol != Protocol::MESI && write_policy != WritePolicy::WriteBack)
+    throw std::runtime_error("protocol moesi/mesif requiere write-policy back");
+  tagmatch::resolve(tag_match);  // lanza si el CPU no soporta la pedida
+  if (bus_ops_per_cycle == 0)
+    throw std::runtime_error("bus-ops debe ser >= 1");
+  if (bus_width == 0 || bus_outstanding == 0)
+    throw std::runtime_error("bus-width y bus-outstanding deben ser >= 1");
+  if (bus_banks == 0)
+    throw std::runtime_error("bus-banks debe ser >= 1");
+  if (sample_every == 0)
+    throw std::runtime_error("sample-every debe ser >= 1");
+}
+
+const char* SimConfig::usage() {
+  return
+    "Uso: mp-mesi [opciones] [programa.asm]\n"
+    "  --step | -s          modo stepping interactivo\n"
+    "  --config FILE        lee 'clave = valor' desde FILE (mismas claves que los flags)\n"
+    "  --pes N              número de PEs (def. 4)\n"
+    "  --mem-words N        palabras de 64b de DRAM (def. 512; dispersa, hasta 2^40)\n"
+    "  --ways N             asociatividad de la caché (def. 2)\n"
+    "  --lines N            líneas totales por caché (def. 16)\n"
+    "  --line-bytes N       bytes por línea, potencia de 2 (def. 32)\n"
+    "  --repl P             reemplazo: lru (def.) | plru | fifo | random | srrip\n"
+    "                       | brrip | drrip (set dueling SRRIP/BRRIP)\n"
+    "  --write-policy P     through (write-through, def.) | back (write-back)\n"
+    "  --protocol P         mesi (def.) | moesi | mesif (caché a caché; requieren back)\n"
+    "  --tag-match M        búsqueda de tag: auto (def.) | scalar | sse41 | avx2\n"
+    "  --bus-ops N          requests que procesa el bus por ciclo (def. 1)\n"
+    "  --bus-model M        atomic (def.) | split (dirección/datos separadas)\n"
+    "  --bus-width N        split: bytes/ciclo de la fase de datos (def. 8)\n"
+    "  --bus-outstanding N  split: transacciones en vuelo (def. 4)\n"
+    "  --lat-rd/--lat-rdx/--lat-upgr/--lat-flush N\n"
+    "                       split: latencia en ciclos por comando (def. 10/10/1/4)\n"
+    "  --bus-banks N        bancos del bus entrelazados por línea (def. 1)\n"
+    "  --bus-threads N      hilos que avanzan los bancos en paralelo (def. 0 = núcleos)\n"
+    "  --coherence M        snoop (broadcast, def.) | directory (sólo a los sharers)\n"
+    "  --snoop-filter on    filtro inclusivo que recorta el broadcast (def. off)\n"
+    "  --dot-n N            elementos de A/B del dot product (def. 16)\n"
+    "  --fuse on|off        superinstrucciones FMUL+FADD y DEC+JNZ en el intérprete (def. on)\n"
+    "  --mem-image FILE     carga la memoria de una imagen binaria (mmap) en vez de input.txt\n"
+    "                       (también en modo demo y --trace)\n"
+    "  --snapshot FILE      al terminar, escribe la memoria como imagen binaria\n"
+    "  --dump-mem R         volcado de la memoria inicial: all (def.) | off | LO:HI\n"
+    "  --trace FILE         modo trace-driven: cada PE reproduce sus accesos de la traza\n"
+    "  --record FILE        graba accesos y requests del bus (sirve de --trace)\n"
+    "  --sample FILE        serie de tiempo: métricas por PE y del bus cada N ticks\n"
+    "  --sample-every N     ticks por intervalo de --sample (def. 1000)\n"
+    "  --sample-format F    csv (def., una fila por PE e intervalo) | jsonl\n"
+    "  --profile P          perfil del host: off (def.) | tsc (fases y hilos con rdtsc)\n"
+    "                       | perf (más cycles/cache-misses por hilo, perf_event_open)\n"
+    "  --engine E           threads (1 hilo por PE, def.) | pool (work stealing)\n"
+    "                       | inline (1 solo hilo, determinista)\n"
+    "  --workers N          hilos del pool (def. 0 = núcleos del host)\n"
+    "  --sync MODE          barrier (spin + futex, def.) | condvar (mutex + condvar)\n"
+    "  --spin N             iteraciones de spin de la barrera antes de dormir (def. 2000)\n";
+}
+
+} // namespace sim
@@ -11,15 +11,23 @@
 #include "types.hpp"
 
 #include "memory.hpp"
+#include "mem_image.hpp"
 #include "bus.hpp"
 #include "cache.hpp"
 #include "processor.hpp"
+#include "trace.hpp"
+#include "recorder.hpp"
+#include "sampler.hpp"
+#include "profiler.hpp"
+#include "vec_ops.hpp"
 #include "debug_io.hpp"
 
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <sstream>
 #include <vector>
 #include <cstdint>
@@ -33,26 +41,74 @@ namespace sim {
 using dbg::to_u64;
 using dbg::to_f64;
 
+namespace {
+
+// Corre f sumando su duración (TSC) al hilo actual en el perfil, si hay
+template <class F>
+inline void timed(Profiler* prof, Profiler::Work w, F&& f) {
+  if (!prof) { f(); return; }
+  const std::uint64_t t0 = Profiler::stamp();
+  f();
+  prof->add_work(w, Profiler::stamp() - t0);
+}
+
+} // namespace
+
 // ---------- Ciclo de vida ----------
 Simulator::~Simulator() {
   stop_threads();  // detener hilos ANTES de destruir Bus/PEs/Caches
 }
 
-Simulator::Simulator() {
+Simulator::Simulator(const SimConfig& cfg) : cfg_(cfg), mem_(cfg_) {
+  cfg_.validate();
+
+  // Memoria inicial de la imagen binaria: vale para asm, demo y --trace
+  if (!cfg_.mem_image.empty()) {
+    const auto st = memimage::load(cfg_.mem_image, mem_);
+    LOG_IF(cfg::kLogSim, "[Sim] mem-image " << cfg_.mem_image << ": " << st.segments
+           << " segmentos, " << st.mapped_bytes << "B mapeados, " << st.copied_bytes << "B copiados");
+  }
+
   // Bus primero (sin cachés)
   std::vector<Cache *> tmp;
-  bus_ = std::make_unique<Bus>(tmp);
+  bus_ = std::make_unique<Bus>(tmp, cfg_);
 
   // Cachés y registro en bus
-  for (std::size_t i = 0; i < cfg::kNumPEs; ++i)
-    caches_[i] = std::make_unique<Cache>(static_cast<PEId>(i), *bus_, mem_);
+  caches_.resize(cfg_.num_pes);
+  for (std::size_t i = 0; i < cfg_.num_pes; ++i)
+    caches_[i] = std::make_unique<Cache>(static_cast<PEId>(i), *bus_, mem_, cfg_, arena_);
   std::vector<Cache*> ptrs;
   for (auto &c : caches_) ptrs.push_back(c.get());
   bus_->set_caches(ptrs);
 
+  // Directorio (opcional): el bus lo consulta en vez de difundir a todos
+  if (cfg_.coherence == CoherenceMode::Directory) {
+    dir_ = std::make_unique<Directory>(cfg_);
+    bus_->set_directory(dir_.get());
+  }
+
   // PEs
-  for (std::size_t i = 0; i < cfg::kNumPEs; ++i)
+  pes_.resize(cfg_.num_pes);
+  for (std::size_t i = 0; i < cfg_.num_pes; ++i)
     pes_[i] = std::make_unique<Processor>(static_cast<PEId>(i), *caches_[i]);
+  for (auto& pe : pes_) pe->set_fusion(cfg_.fuse);
+
+  // --snapshot se escribe al final: un path inválido tiene que fallar antes del run
+  if (!cfg_.snapshot.empty()) memimage::check_writable(cfg_.snapshot);
+
+  // Grabación (opcional): accesos de los PEs + requests del bus
+  if (!cfg_.record.empty()) {
+    rec_ = std::make_unique<Recorder>(cfg_.record, cfg_.num_pes, bus_->banks());
+    bus_->set_recorder(rec_.get());
+    for (auto& pe : pes_) pe->set_recorder(rec_.get());
+  }
+
+  // Serie de tiempo (opcional): métricas por intervalo de ticks
+  if (!cfg_.sample.empty())
+    sampler_ = std::make_unique<Sampler>(cfg_.sample, cfg_.sample_format, cfg_.sample_every, cfg_.num_pes);
+
+  // Perfil del host (opcional): antes de lanzar los hilos, que lo usan
+  if (cfg_.profile != ProfileMode::Off) prof_ = std::make_unique<Profiler>(cfg_.profile);
 
   // Lanzar hilos (quedan en Idle)
   start_threads();
@@ -60,18 +116,60 @@ Simulator::Simulator() {
 
 // ---------- Multihilo ----------
 void Simulator::start_threads() {
+  if (cfg_.engine == Engine::Inline) return;  // no usa hilos
+
+  // Bancos del bus en paralelo: el engine pool reutiliza sus workers (en la
+  // fase bus están ociosos); el de hilos le da al hilo del bus un pool propio
+  if (cfg_.engine == Engine::Threads && !bus_pool_ && bus_->banks() > 1 && bus_->parallel_safe()) {
+    const std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t w  = std::min(cfg_.bus_threads ? cfg_.bus_threads : hw, bus_->banks());
+    if (w > 1)
+      bus_pool_ = std::make_unique<WorkStealingPool>(w, static_cast<std::uint32_t>(w <= hw ? cfg_.spin_limit : 0));
+  }
+
+  if (cfg_.engine == Engine::Pool) {
+    if (pool_) return;
+    // Workers = núcleos del host (o --workers), nunca más que PEs
+    const std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t w  = std::min(cfg_.workers ? cfg_.workers : hw, cfg_.num_pes);
+    pool_ = std::make_unique<WorkStealingPool>(w, static_cast<std::uint32_t>(w <= hw ? cfg_.spin_limit : 0));
+    return;
+  }
+
+  if (cfg_.sync == SyncMode::Barrier) {
+    if (threads_started_) return;
+
+    // Participantes: main + PEs + bus. Si hay más hilos que núcleos, el spin
+    // sólo le quita CPU al que falta llegar: vamos directo al futex.
+    const std::size_t parties = cfg_.num_pes + 2;
+    const std::size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    const auto spin = static_cast<std::uint32_t>(parties <= hw ? cfg_.spin_limit : 0);
+    tick_barrier_ = std::make_unique<SpinParkBarrier>(parties, spin);
+    bus_barrier_  = std::make_unique<SpinParkBarrier>(2, spin);
+    halt_.store(false, std::memory_order_relaxed);
+
+    pe_threads_.resize(cfg_.num_pes);
+    for (std::size_t i = 0; i < cfg_.num_pes; ++i)
+      pe_threads_[i] = std::thread(&Simulator::worker_pe_barrier, this, i);
+    bus_thread_ = std::thread(&Simulator::worker_bus_barrier, this);
+
+    threads_started_ = true;
+    return;
+  }
+
   std::lock_guard<std::mutex> lk(m_);
   if (threads_started_) return;
 
   tick_ = 0;
   pe_done_count_ = 0;
   bus_done_ = false;
-  pe_last_tick_.fill(0);
+  pe_last_tick_.assign(cfg_.num_pes, 0);
+  pe_threads_.resize(cfg_.num_pes);
   bus_last_tick_ = 0;
   phase_ = Phase::Idle;
 
   // Hilos de PEs
-  for (std::size_t i = 0; i < cfg::kNumPEs; ++i) {
+  for (std::size_t i = 0; i < cfg_.num_pes; ++i) {
     pe_threads_[i] = std::thread(&Simulator::worker_pe, this, i);
   }
   // Hilo de BUS
@@ -81,6 +179,25 @@ void Simulator::start_threads() {
 }
 
 void Simulator::stop_threads() {
+  if (cfg_.engine == Engine::Inline) return;
+
+  if (cfg_.engine == Engine::Pool) {
+    pool_.reset();
+    return;
+  }
+
+  if (cfg_.sync == SyncMode::Barrier) {
+    if (!threads_started_) return;
+    // Todos esperan en la apertura del próximo tick: la abrimos con halt_ puesto
+    halt_.store(true, std::memory_order_release);
+    tick_barrier_->arrive_and_wait();
+
+    for (auto& t : pe_threads_) if (t.joinable()) t.join();
+    if (bus_thread_.joinable()) bus_thread_.join();
+    threads_started_ = false;
+    return;
+  }
+
   std::unique_lock<std::mutex> lk(m_);
   if (!threads_started_) return;
 
@@ -114,16 +231,13 @@ void Simulator::worker_pe(std::size_t pe_idx) {
     }
 
     lk.unlock();
-    // --- Trabajo del PE en este tick (1 instrucción máx.) ---
-    if (!pes_[pe_idx]->is_done()) {
-      pes_[pe_idx]->step(); // logs dentro
-    }
+    step_pe(pe_idx);  // trabajo del PE en este tick (1 instrucción máx., logs dentro)
     lk.lock();
 
     // Marcar completado para este tick
     pe_last_tick_[pe_idx] = mytick;
     ++pe_done_count_;
-    if (pe_done_count_ == cfg::kNumPEs) cv_.notify_all();
+    if (pe_done_count_ == cfg_.num_pes) cv_.notify_all();
 
     // Esperar al SIGUIENTE TICK (no sólo cambio de fase)
     cv_.wait(lk, [&]{ return tick_ != mytick || phase_ == Phase::Halt; });
@@ -147,7 +261,7 @@ void Simulator::worker_bus() {
     }
 
     lk.unlock();
-    bus_->step();  // logs dentro
+    step_bus();  // logs dentro
     lk.lock();
 
     bus_last_tick_ = mytick;
@@ -160,7 +274,82 @@ void Simulator::worker_bus() {
   }
 }
 
+void Simulator::worker_pe_barrier(std::size_t pe_idx) {
+  while (true) {
+    tick_barrier_->arrive_and_wait();               // apertura de fase PE
+    if (halt_.load(std::memory_order_acquire)) break;
+
+    step_pe(pe_idx);  // trabajo del PE en este tick (1 instrucción máx., logs dentro)
+
+    tick_barrier_->arrive_and_wait();               // fin de fase PE
+  }
+}
+
+void Simulator::worker_bus_barrier() {
+  while (true) {
+    tick_barrier_->arrive_and_wait();               // apertura de fase PE
+    if (halt_.load(std::memory_order_acquire)) break;
+    tick_barrier_->arrive_and_wait();               // esperar a que terminen los PEs
+
+    step_bus();  // logs dentro
+
+    bus_barrier_->arrive_and_wait();                // fin de fase bus
+  }
+}
+
+void Simulator::step_bus() {
+  WorkStealingPool* p = cfg_.engine == Engine::Pool ? pool_.get() : bus_pool_.get();
+  if (p && bus_->banks() > 1 && bus_->parallel_safe()) {
+    p->run(bus_->banks(), [this](std::size_t b){
+      timed(prof_.get(), Profiler::Bus, [&]{ bus_->step_bank(b); });
+    });
+    return;
+  }
+  timed(prof_.get(), Profiler::Bus, [&]{ bus_->step(); });
+}
+
+void Simulator::step_pe(std::size_t pe) {
+  if (pes_[pe]->is_done()) return;
+  timed(prof_.get(), Profiler::PE, [&]{ pes_[pe]->step(); });
+}
+
 void Simulator::advance_one_tick_blocking() {
+  ++ticks_run_;
+  if (rec_) rec_->set_tick(ticks_run_);  // antes de abrir las fases (las barreras lo publican)
+  if (prof_) prof_->tick_begin();
+  run_tick_phases();
+  if (prof_) prof_->tick_end();
+  // Fases cerradas: las métricas de cachés y bus se leen sin carreras
+  if (sampler_ && sampler_->due(ticks_run_)) sampler_->sample(ticks_run_, caches_, *bus_);
+}
+
+void Simulator::run_tick_phases() {
+
+  if (cfg_.engine == Engine::Inline) {
+    // Fase 1: PEs en orden fijo; Fase 2: bus. Sin handshakes entre hilos.
+    for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe) step_pe(pe);
+    if (prof_) prof_->pe_phase_done();
+    timed(prof_.get(), Profiler::Bus, [&]{ bus_->step(); });
+    return;
+  }
+
+  if (cfg_.engine == Engine::Pool) {
+    // Fase 1: todos los PEs repartidos en el pool (vuelve cuando terminaron todos)
+    pool_->run(cfg_.num_pes, [this](std::size_t pe){ step_pe(pe); });
+    if (prof_) prof_->pe_phase_done();
+    // Fase 2: bus en este mismo hilo (bancos repartidos en el pool)
+    step_bus();
+    return;
+  }
+
+  if (cfg_.sync == SyncMode::Barrier) {
+    tick_barrier_->arrive_and_wait();  // Fase 1: PEs
+    tick_barrier_->arrive_and_wait();  // ... terminaron todos
+    if (prof_) prof_->pe_phase_done();
+    bus_barrier_->arrive_and_wait();   // Fase 2: BUS terminado
+    return;
+  }
+
   std::unique_lock<std::mutex> lk(m_);
 
   // Preparar nuevo tick
@@ -171,8 +360,9 @@ void Simulator::advance_one_tick_blocking() {
   // Fase 1: PEs
   phase_ = Phase::RunPE;
   cv_.notify_all();
-  cv_.wait(lk, [&]{ return pe_done_count_ == cfg::kNumPEs || phase_ == Phase::Halt; });
+  cv_.wait(lk, [&]{ return pe_done_count_ == cfg_.num_pes || phase_ == Phase::Halt; });
   if (phase_ == Phase::Halt) return;
+  if (prof_) prof_->pe_phase_done();
 
   // Fase 2: BUS
   phase_ = Phase::RunBus;
@@ -198,10 +388,19 @@ bool Simulator::init_vectors_from_file(Addr baseA, Addr baseB, std::size_t N) {
   while (std::getline(fin, lineB) && !nonempty(lineB)) {}
   if (lineA.empty() || lineB.empty()) return false;
 
+  // from_chars en vez de istringstream: sin locale ni copias por número
   auto parse_line = [](const std::string &s) {
     std::vector<double> v;
-    std::istringstream is(s);
-    for (double d; is >> d; ) v.push_back(d);
+    const char* p = s.data();
+    const char* end = p + s.size();
+    while (true) {
+      while (p < end && std::isspace(static_cast<unsigned char>(*p))) ++p;
+      double d;
+      auto [next, ec] = std::from_chars(p, end, d);
+      if (ec != std::errc{}) break;
+      v.push_back(d);
+      p = next;
+    }
     return v;
   };
   const auto va = parse_line(lineA);
@@ -222,21 +421,36 @@ bool Simulator::init_vectors_from_file(Addr baseA, Addr baseB, std::size_t N) {
 }
 
 void Simulator::dump_initial_memory() const {
+  if (!cfg_.dump_mem) return;
   SOUT << "\n========== CONTENIDO DE MEMORIA (inicial) ==========\n";
-  for (std::size_t addr = 0; addr < cfg::kMemWords * cfg::kWordBytes; addr += 8) {
-    std::uint64_t v = mem_.read64(addr);
-    double d; std::memcpy(&d, &v, sizeof(double));
-    SOUT << "0x" << std::hex << std::setw(4) << addr << std::dec
-         << " : " << std::fixed << std::setprecision(6) << d << "\n";
-  }
+  // Sólo las páginas presentes (el resto de la memoria dispersa vale 0) y
+  // dentro del rango de --dump-mem
+  const Addr limit = std::min<Addr>(mem_.words() * cfg::kWordBytes, cfg_.dump_mem_hi);
+  mem_.for_each_resident_page([&](Addr page) {
+    const Addr end = std::min<Addr>(page + Memory::kPageBytes, limit);
+    for (Addr addr = std::max<Addr>(page, cfg_.dump_mem_lo & ~Addr{7}); addr < end; addr += 8) {
+      std::uint64_t v = mem_.read64(addr);
+      double d; std::memcpy(&d, &v, sizeof(double));
+      SOUT << "0x" << std::hex << std::setw(4) << addr << std::dec
+           << " : " << std::fixed << std::setprecision(6) << d << "\n";
+    }
+  });
   SOUT << "====================================================\n";
 }
 
+Simulator::DotLayout Simulator::dot_layout(const SimConfig& cfg) {
+  const std::size_t N = cfg.dot_n;
+  auto align_up = [&](std::size_t b){ return (b + cfg.line_bytes - 1) / cfg.line_bytes * cfg.line_bytes; };
+  const Addr baseB = std::max<std::size_t>(0x100, align_up(N * 8));
+  return {0x000, baseB, std::max<std::size_t>(0x200, baseB + align_up(N * 8))};
+}
+
 void Simulator::init_dot_problem(std::size_t N, Addr baseA, Addr baseB, Addr basePS) {
   dot_.N = N; dot_.baseA = baseA; dot_.baseB = baseB; dot_.basePS = basePS;
 
-  // DRAM: A y B como double (8B)
-  if (!init_vectors_from_file(baseA, baseB, N)) {
+  // DRAM: A y B como double (8B), de la imagen binaria (ya cargada en el
+  // constructor), de input.txt o por defecto
+  if (cfg_.mem_image.empty() && !init_vectors_from_file(baseA, baseB, N)) {
     for (std::size_t i = 0; i < N; ++i) {
       mem_.write64(baseA + i*8, to_u64(static_cast<double>(i + 1)));
       mem_.write64(baseB + i*8, to_u64(1.0));
@@ -250,7 +464,7 @@ void Simulator::init_dot_problem(std::size_t N, Addr baseA, Addr baseB, Addr bas
   });
 
   // Partición por PE
-  dot_.seg = N / cfg::kNumPEs;
+  dot_.seg = N / cfg_.num_pes;
   for_each_pe([&](std::size_t pe){
     pes_[pe]->set_reg(0, dot_.seg);
     pes_[pe]->set_reg(1, baseA + pe*dot_.seg*8);
@@ -282,6 +496,20 @@ void Simulator::load_program_all_from_file(const std::string &path) {
   load_program_all(p);
 }
 
+void Simulator::load_trace_all_from_file(const std::string &path) {
+  auto file = std::make_shared<const TraceFile>(path);
+  if (file->pes() > cfg_.num_pes)
+    throw std::runtime_error("La traza usa " + std::to_string(file->pes()) +
+                             " PEs y el sistema tiene " + std::to_string(cfg_.num_pes));
+  for_each_pe([&](std::size_t i){
+    pes_[i]->load_trace(std::make_unique<TraceReader>(file, static_cast<PEId>(i)));
+  });
+  trace_mode_     = true;
+  trace_accesses_ = file->accesses();
+  SERR << "[Trace] " << path << ": " << trace_accesses_ << " accesos, "
+       << file->pes() << " PEs con traza\n";
+}
+
 // ---------- Factorización: helpers de finalización ----------
 void Simulator::do_final_reduction_and_print() {
   Program p;
@@ -289,7 +517,7 @@ void Simulator::do_final_reduction_and_print() {
   Instr warm2; warm2.op = OpCode::LOAD;  warm2.rd = 7; warm2.ra  = 1;
 
   Instr m1;   m1.op   = OpCode::MOVI;    m1.rd = 1; m1.imm = dot_.basePS;
-  Instr m2;   m2.op   = OpCode::MOVI;    m2.rd = 2; m2.imm = cfg::kNumPEs;
+  Instr m2;   m2.op   = OpCode::MOVI;    m2.rd = 2; m2.imm = cfg_.num_pes;
   Instr r;    r.op    = OpCode::REDUCE;  r.rd = 4; r.ra = 1; r.rb = 2;
   Instr st;   st.op   = OpCode::STORE;   st.ra = 4; st.rd = 3;
 
@@ -297,9 +525,10 @@ void Simulator::do_final_reduction_and_print() {
   pes_[0]->load_program(p);
 
   std::size_t k = 0;
-  while (!pes_[0]->is_done() && k++ < 2000) {
+  while (!pes_[0]->is_done() && k++ < 100000) {  // write-back: los loads esperan al bus
     advance_one_tick_blocking();
   }
+  log::flush();
 
   std::uint64_t bits = pes_[0]->get_reg(4);
   double final; std::memcpy(&final, &bits, sizeof(double));
@@ -318,7 +547,7 @@ void Simulator::do_final_reduction_and_print() {
 
 void Simulator::dump_metrics() const {
   SOUT << "----- Métricas de desempeño -----\n";
-  for (std::size_t i = 0; i < cfg::kNumPEs; ++i) {
+  for (std::size_t i = 0; i < cfg_.num_pes; ++i) {
     const auto &m = caches_[i]->metrics();
     SOUT << "PE" << i
          << " | Loads: " << m.loads
@@ -336,6 +565,84 @@ void Simulator::dump_metrics() const {
          << " }"
          << "\n";
   }
+
+  // Reemplazo: totales de todas las cachés (misma política en todas)
+  std::uint64_t evictions = 0, invalid_fills = 0, distant = 0;
+  for (const auto& c : caches_) {
+    evictions     += c->metrics().repl_evictions;
+    invalid_fills += c->metrics().repl_invalid_fills;
+    distant       += c->replacement().distant_inserts();
+  }
+  SOUT << "Replacement: policy=" << to_string(cfg_.repl)
+       << " | evictions=" << evictions
+       << " | invalid_fills=" << invalid_fills;
+  if (cfg_.repl == ReplPolicy::BRRIP || cfg_.repl == ReplPolicy::DRRIP)
+    SOUT << " | distant_inserts=" << distant;
+  if (cfg_.repl == ReplPolicy::DRRIP) {
+    // Cuántas cachés tienen sus followers en BRRIP al final
+    std::size_t brrip = 0;
+    for (const auto& c : caches_) brrip += c->replacement().followers_use_brrip() ? 1 : 0;
+    SOUT << " | drrip_brrip_caches=" << brrip << "/" << caches_.size();
+  }
+  SOUT << "\n";
+
+  // Tráfico a DRAM: write-through escribe cada store, write-back sólo las víctimas sucias
+  std::uint64_t dram_rd = 0, dram_wr = 0, writebacks = 0, stalls = 0;
+  for (const auto& c : caches_) {
+    const auto& m = c->metrics();
+    dram_rd    += m.dram_read_bytes;
+    dram_wr    += m.dram_write_bytes;
+    writebacks += m.writebacks;
+    stalls     += m.stall_cycles;
+  }
+  SOUT << "DRAM: policy=" << (cfg_.write_policy == WritePolicy::WriteBack ? "write-back" : "write-through")
+       << " | reads=" << dram_rd << "B"
+       << " | writes=" << dram_wr << "B"
+       << " | writebacks=" << writebacks
+       << " | stalls=" << stalls
+       << " | resident=" << mem_.resident_pages() << " pages ("
+       << mem_.resident_pages() * Memory::kPageBytes / 1024 << " KiB)";
+  if (mem_.mapped_pages())
+    SOUT << " | mapped=" << mem_.mapped_pages() << " pages";
+  SOUT << "\n";
+
+  // MOESI/MESIF: lo que el protocolo ahorró a DRAM (fills caché a caché y Flush evitados)
+  std::uint64_t c2c = 0, wr_avoided = 0;
+  for (const auto& c : caches_) {
+    c2c        += c->metrics().c2c_fills;
+    wr_avoided += c->metrics().dram_writes_avoided;
+  }
+  SOUT << "Protocol: " << (cfg_.protocol == Protocol::MOESI ? "moesi"
+                           : cfg_.protocol == Protocol::MESIF ? "mesif" : "mesi")
+       << " | c2c_transfers=" << c2c
+       << " | dram_reads_saved=" << c2c * cfg_.line_bytes << "B"
+       << " | dram_writes_saved=" << wr_avoided << "B\n";
+
+  // Superinstrucciones del intérprete (no cambian ticks ni métricas de caché)
+  if (!trace_mode_) {
+    Processor::FusionStats fs;
+    for (const auto& pe : pes_) {
+      fs.retired += pe->fusion_stats().retired;
+      fs.fmuladd += pe->fusion_stats().fmuladd;
+      fs.decjnz  += pe->fusion_stats().decjnz;
+    }
+    const std::uint64_t fused = 2 * (fs.fmuladd + fs.decjnz);
+    SOUT << "Fusion: " << (cfg_.fuse ? "on" : "off")
+         << " | retired=" << fs.retired
+         << " | fmuladd=" << fs.fmuladd
+         << " | decjnz=" << fs.decjnz
+         << " | fused_instrs=" << std::fixed << std::setprecision(1)
+         << (fs.retired ? 100.0 * static_cast<double>(fused) / static_cast<double>(fs.retired) : 0.0)
+         << "%" << std::defaultfloat << "\n";
+
+    // Instrucciones vectoriales (sólo si el programa las usa)
+    std::uint64_t vec = 0;
+    for (const auto& pe : pes_) vec += pe->vector_retired();
+    if (vec)
+      SOUT << "Vector: VL=" << pes_.front()->vector_lanes()
+           << " | kernels=" << vecops::kernels().name
+           << " | retired=" << vec << "\n";
+  }
   SOUT << "-----------------------------------------------------------------------------------\n";
 }
 
@@ -345,7 +652,75 @@ void Simulator::dump_bus_stats() const {
        << " | BusRdX=" << bus_->count_cmd(BusCmd::BusRdX)
        << " | Upgr="   << bus_->count_cmd(BusCmd::BusUpgr)
        << " | Flushes="<< bus_->flushes()
+       << " | Snoops=" << bus_->snoops()
        << "\n";
+  if (bus_->split()) {
+    const auto st = bus_->split_stats();
+    const double n = st.completed ? static_cast<double>(st.completed) : 1.0;
+    const double cyc = bus_->cycles() ? static_cast<double>(bus_->cycles()) : 1.0;
+    SOUT << std::fixed << std::setprecision(2)
+         << "BusSplit: cycles=" << bus_->cycles()
+         << " | completed=" << st.completed
+         << " | queue_delay avg=" << st.queue_delay_sum / n << " max=" << st.queue_delay_max
+         << " | latency avg=" << st.latency_sum / n << " max=" << st.latency_max
+         << " | data_util=" << 100.0 * st.data_busy_cycles / (cyc * bus_->banks()) << "%"
+         << " | bytes/cycle=" << bus_->bytes() / cyc
+         << " | addr_stalls=" << st.addr_stalls
+         << "\n";
+  }
+  if (bus_->banks() > 1) {
+    const WorkStealingPool* p = cfg_.engine == Engine::Pool ? pool_.get() : bus_pool_.get();
+    const double cyc = bus_->cycles() ? static_cast<double>(bus_->cycles()) : 1.0;
+    SOUT << "BusBanks: " << bus_->banks()
+         << " | parallel=" << (p && bus_->parallel_safe() ? "yes" : "no")
+         << (bus_->parallel_safe() ? "" : " (sets % bancos != 0)") << "\n";
+    for (std::size_t b = 0; b < bus_->banks(); ++b) {
+      const auto st = bus_->bank_stats(b);
+      SOUT << std::fixed << std::setprecision(2)
+           << "  bank" << b << ": requests=" << st.requests
+           << " | bytes=" << st.bytes
+           << " | util=" << 100.0 * st.busy_cycles / cyc << "%"
+           << " | max_queue=" << st.max_depth
+           << "\n";
+    }
+  }
+  if (const auto* sf = bus_->snoop_filter()) {
+    SOUT << "SnoopFilter: hits=" << sf->hits()
+         << " | misses=" << sf->misses()
+         << " | snoops_avoided=" << sf->snoops_avoided()
+         << " | lines_tracked=" << sf->tracked_lines()
+         << "\n";
+  }
+  if (dir_) {
+    SOUT << "Directory: lookups=" << dir_->lookups()
+         << " | p2p_msgs=" << bus_->p2p_msgs()
+         << " | evict_notices=" << dir_->evict_notices()
+         << " | lines_tracked=" << dir_->tracked_lines()
+         << " | snoops_vs_broadcast=" << bus_->snoops() << "/"
+         << (bus_->count_cmd(BusCmd::BusRd) + bus_->count_cmd(BusCmd::BusRdX)
+             + bus_->count_cmd(BusCmd::BusUpgr)) * (cfg_.num_pes - 1)
+         << "\n";
+  }
+}
+
+void Simulator::dump_tick_rate(std::size_t ticks, std::chrono::steady_clock::duration wall) const {
+  const double secs = std::chrono::duration<double>(wall).count();
+  SOUT << "[Sim] ticks=" << ticks
+       << " | wall=" << std::fixed << std::setprecision(6) << secs << " s"
+       << " | ticks/s=" << std::setprecision(0) << (secs > 0 ? ticks / secs : 0.0)
+       << " | engine=";
+  switch (cfg_.engine) {
+    case Engine::Inline:
+      SOUT << "inline";
+      break;
+    case Engine::Pool:
+      SOUT << "pool | workers=" << pool_->workers() << " | steals=" << pool_->steals();
+      break;
+    case Engine::Threads:
+      SOUT << "threads | sync=" << (cfg_.sync == SyncMode::Barrier ? "barrier" : "condvar");
+      break;
+  }
+  SOUT << "\n";
 }
 
 double Simulator::ref_dot_cpu() const {
@@ -363,7 +738,7 @@ void Simulator::dump_all_pes_and_ref() const {
   SOUT << std::fixed << std::setprecision(6);
   SOUT << "[Referencia CPU] dot(A,B) con N=" << dot_.N << " -> " << ref_dot_cpu() << "\n\n";
 
-  for (std::size_t pe = 0; pe < cfg::kNumPEs; ++pe) {
+  for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe) {
     SOUT << "---- PE" << pe << " -------------------------------------------------\n";
 
     SOUT << "REGISTROS:\n";
@@ -412,12 +787,55 @@ void Simulator::dump_all_pes_and_ref() const {
 
 // ---------- Ejecución: función común ----------
 void Simulator::run_and_finalize(const std::function<void()>& runner) {
+  const std::size_t ticks0 = ticks_run_;
+  if (prof_) prof_->run_begin();
+  const auto t0 = std::chrono::steady_clock::now();
   runner(); // corre (por ciclos o hasta done)
+  const auto wall = std::chrono::steady_clock::now() - t0;
+  log::flush();  // los logs del run antes que el resumen
   SOUT << "[Sim] Ejecución completada.\n\n";
-  do_final_reduction_and_print();
+  dump_tick_rate(ticks_run_ - ticks0, wall);
+  if (prof_) {
+    std::uint64_t instr = 0;
+    for (const auto& pe : pes_) instr += pe->fusion_stats().retired;
+    std::ostringstream os;
+    if (trace_mode_) prof_->report(os, trace_accesses_, "accesos");
+    else             prof_->report(os, instr, "instr");
+    SOUT << os.str();
+  }
+  if (trace_mode_) {
+    const double secs = std::chrono::duration<double>(wall).count();
+    SOUT << "[Trace] accesos=" << trace_accesses_;
+    if (secs > 0) SOUT << " (" << static_cast<std::uint64_t>(trace_accesses_ / secs) << " accesos/s)";
+    SOUT << "\n";
+  } else {
+    do_final_reduction_and_print();
+  }
+  if (sampler_) {
+    sampler_->finish(ticks_run_, caches_, *bus_);
+    SERR << "[Sample] " << cfg_.sample << ": " << sampler_->samples() << " muestras cada "
+         << cfg_.sample_every << " ticks, " << sampler_->bytes_written() << " B\n";
+  }
+  if (rec_) {
+    rec_->close();
+    const std::uint64_t n = rec_->accesses() + rec_->bus_records();
+    SERR << "[Record] " << cfg_.record << ": " << rec_->accesses() << " accesos, "
+         << rec_->bus_records() << " requests, " << rec_->bytes_written() << " B ("
+         << std::fixed << std::setprecision(2)
+         << (n ? static_cast<double>(rec_->bytes_written()) / static_cast<double>(n) : 0.0)
+         << std::defaultfloat << " B/registro)\n";
+  }
+  // Write-back: lo sucio sólo está en las cachés; se baja a DRAM para el volcado
+  if (cfg_.write_policy == WritePolicy::WriteBack)
+    for (auto& c : caches_) c->write_back_all();
   dump_metrics();
   dump_bus_stats();
-  dump_all_pes_and_ref();
+  if (!trace_mode_) dump_all_pes_and_ref();
+  // Último: si falla (disco lleno, ...) el reporte del run ya salió
+  if (!cfg_.snapshot.empty()) {
+    const std::size_t segs = memimage::save(cfg_.snapshot, mem_);
+    SERR << "[Sim] Snapshot de memoria: " << cfg_.snapshot << " (" << segs << " segmentos)\n";
+  }
 }
 
 void Simulator::run_cycles(std::size_t cycles) {
@@ -432,7 +850,9 @@ void Simulator::run_until_done(std::size_t safety_max) {
   run_and_finalize([&](){
     std::size_t after_done_bus_steps = 0;
     for (std::size_t c = 0; c < safety_max; ++c) {
-      const bool already_done = all_done();
+      // Con muchos PEs la cola del bus puede seguir cargada cuando terminan:
+      // hay que drenarla antes de la reducción final (si no, quedan copias viejas).
+      const bool already_done = all_done() && bus_->pending() == 0;
       advance_one_tick_blocking();
       if (already_done) {
         if (++after_done_bus_steps >= 2) break;
@@ -450,12 +870,12 @@ bool Simulator::all_done() const {
 }
 
 void Simulator::dump_cache(std::size_t pe, std::optional<std::size_t> only_set) const {
-  if (pe >= cfg::kNumPEs) return;
+  if (pe >= cfg_.num_pes) return;
   caches_[pe]->debug_dump(std::cout, only_set, /*with_data=*/true);
 }
 
 void Simulator::dump_regs(std::size_t pe) const {
-  if (pe >= cfg::kNumPEs) return;
+  if (pe >= cfg_.num_pes) return;
   SOUT << "REGISTROS PE" << pe << ":\n";
   for (int r = 0; r < 8; ++r) {
     std::uint64_t u = pes_[pe]->get_reg(r);
@@ -0,0 +1,19 @@
+#include "snoop_filter.hpp"
+
+namespace sim
+{
+
+SnoopFilter::SnoopFilter(const SimConfig& cfg) : map_(cfg) {}
+
+SharerSet SnoopFilter::lookup(Addr line_addr, PEId source) {
+  SharerSet s = map_.get(line_addr).sharers;
+  const std::size_t num_pes = map_.num_pes();
+  if (source < num_pes) s.reset(source); // sin self-snoop
+
+  const std::size_t n = s.count();
+  (n ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+  avoided_.fetch_add((num_pes - 1) - n, std::memory_order_relaxed);
+  return s;
+}
+
+} // namespace sim
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <array>
+#include <vector>
 
 namespace sim {
 
@@ -19,6 +21,9 @@ void Simulator::run_stepping() {
   SOUT << "\n===================== STEPPING INTERACTIVO =====================\n"
        << "ENTER=step | c=continuar | r=regs | b=bus | q=salir\n";
 
+  // Sin superinstrucciones: los diffs de registros tienen que ser por instrucción
+  for (auto& pe : pes_) pe->set_fusion(false);
+
   bool auto_run = false;
   std::size_t step = 0;
 
@@ -29,7 +34,7 @@ void Simulator::run_stepping() {
       if (!std::getline(std::cin, line)) { SOUT << "\n[Stepping] stdin cerrado. Saliendo.\n"; break; }
       if (line == "q" || line == "Q") { SOUT << "[Stepping] Salir.\n"; break; }
       if (line == "c" || line == "C") { auto_run = true; SOUT << "[Stepping] Continuación automática habilitada.\n"; }
-      else if (line == "r" || line == "R") { for (std::size_t pe = 0; pe < cfg::kNumPEs; ++pe) dump_regs(pe); continue; }
+      else if (line == "r" || line == "R") { for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe) dump_regs(pe); continue; }
       else if (line == "b" || line == "B") { dump_bus_stats(); continue; }
     }
 
@@ -43,11 +48,11 @@ void Simulator::run_stepping() {
 
 void Simulator::step_one() {
   // Snapshot BEFORE
-  std::array<std::array<std::uint64_t, 8>, cfg::kNumPEs> before{};
-  for (std::size_t pe = 0; pe < cfg::kNumPEs; ++pe)
+  std::vector<std::array<std::uint64_t, 8>> before(cfg_.num_pes);
+  for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe)
     for (int r = 0; r < 8; ++r) before[pe][r] = pes_[pe]->get_reg(r);
 
-  for (std::size_t pe = 0; pe < cfg::kNumPEs; ++pe) {
+  for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe) {
     if (pes_[pe]->is_done()) { SOUT << "[PE" << pe << "] DONE (no ejecuta)\n"; continue; }
     SOUT << "[PE" << pe << "] BEFORE: ";
     print_reg_compact(std::cout, 0, before[pe][0]); SOUT << " | ";
@@ -57,12 +62,13 @@ void Simulator::step_one() {
     print_reg_compact(std::cout, 4, before[pe][4]); SOUT << "\n";
   }
 
-  // 1 tick completo
+  // 1 tick completo (y sus logs antes de los diffs)
   advance_one_tick_blocking();
+  log::flush();
 
   // Diffs AFTER
   SOUT << "\n--- REG DIFFS (AFTER) ---\n";
-  for (std::size_t pe = 0; pe < cfg::kNumPEs; ++pe) {
+  for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe) {
     std::array<std::uint64_t, 8> after{};
     for (int r = 0; r < 8; ++r) after[r] = pes_[pe]->get_reg(r);
 
@@ -81,7 +87,7 @@ void Simulator::step_one() {
 
   // Dump de caché por PE
   SOUT << "\n----------------------- CACHE DUMP (por paso) -----------------------\n";
-  for (std::size_t pe = 0; pe < cfg::kNumPEs; ++pe) {
+  for (std::size_t pe = 0; pe < cfg_.num_pes; ++pe) {
     SOUT << "[PE" << pe << "]\n";
     caches_[pe]->debug_dump(std::cout, std::nullopt, /*with_data=*/true);
     SOUT << "------------------------------------------------------------------\n";
@@ -0,0 +1,106 @@
+#include "tag_match.hpp"
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MPMESI_X86 1
+#else
+#define MPMESI_X86 0
+#endif
+
+namespace sim::tagmatch
+{
+
+#if MPMESI_X86
+// Cada variante se compila con su 'target' (el resto del binario queda en el
+// ISA base) y sólo se llama si __builtin_cpu_supports lo confirmó.
+
+// Igual que el escalar: máscara completa por bloque de 64 ways y un solo
+// salto al final (el "en qué way pegó" de un hit es aleatorio y no se predice).
+
+__attribute__((target("sse4.1")))
+int find_sse41(const std::uint64_t* tags, std::size_t n, std::uint64_t tag) {
+  const __m128i key = _mm_set1_epi64x(static_cast<long long>(tag));
+  for (std::size_t i = 0; i < n; i += 64) {
+    const std::size_t e = n - i < 64 ? n - i : 64;
+    std::uint64_t m = 0;
+    std::size_t j = 0;
+    for (; j + 2 <= e; j += 2) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i + j));
+      m |= static_cast<std::uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(v, key)))) << j;
+    }
+    if (j < e) m |= static_cast<std::uint64_t>(tags[i + j] == tag) << j;
+    if (m) return static_cast<int>(i) + __builtin_ctzll(m);
+  }
+  return -1;
+}
+
+__attribute__((target("avx2")))
+int find_avx2(const std::uint64_t* tags, std::size_t n, std::uint64_t tag) {
+  const __m256i key = _mm256_set1_epi64x(static_cast<long long>(tag));
+  for (std::size_t i = 0; i < n; i += 64) {
+    const std::size_t e = n - i < 64 ? n - i : 64;
+    std::uint64_t m = 0;
+    std::size_t j = 0;
+    for (; j + 4 <= e; j += 4) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i + j));
+      m |= static_cast<std::uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, key)))) << j;
+    }
+    if (j + 2 <= e) {  // AVX2 implica SSE4.1: el resto de a 2
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i + j));
+      m |= static_cast<std::uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(v, _mm256_castsi256_si128(key))))) << j;
+      j += 2;
+    }
+    if (j < e) m |= static_cast<std::uint64_t>(tags[i + j] == tag) << j;
+    if (m) return static_cast<int>(i) + __builtin_ctzll(m);
+  }
+  return -1;
+}
+
+bool supported(TagMatch m) {
+  switch (m) {
+    case TagMatch::Sse41: return __builtin_cpu_supports("sse4.1");
+    case TagMatch::Avx2:  return __builtin_cpu_supports("avx2");
+    default:              return true;
+  }
+}
+
+#else
+// Sin x86: las variantes SIMD caen al escalar y se reportan como no soportadas
+int find_sse41(const std::uint64_t* tags, std::size_t n, std::uint64_t tag) { return find_scalar(tags, n, tag); }
+int find_avx2(const std::uint64_t* tags, std::size_t n, std::uint64_t tag)  { return find_scalar(tags, n, tag); }
+
+bool supported(TagMatch m) { return m == TagMatch::Auto || m == TagMatch::Scalar; }
+#endif
+
+TagMatch resolve(TagMatch m) {
+  if (m == TagMatch::Auto) {
+    if (supported(TagMatch::Avx2))  return TagMatch::Avx2;
+    if (supported(TagMatch::Sse41)) return TagMatch::Sse41;
+    return TagMatch::Scalar;
+  }
+  if (!supported(m))
+    throw std::runtime_error(std::string("tag-match '") + name(m) + "' no soportado por este CPU");
+  return m;
+}
+
+FindFn function(TagMatch m) {
+  switch (m) {
+    case TagMatch::Sse41: return &find_sse41;
+    case TagMatch::Avx2:  return &find_avx2;
+    default:              return &find_scalar;
+  }
+}
+
+const char* name(TagMatch m) {
+  switch (m) {
+    case TagMatch::Auto:   return "auto";
+    case TagMatch::Scalar: return "scalar";
+    case TagMatch::Sse41:  return "sse41";
+    case TagMatch::Avx2:   return "avx2";
+  }
+  return "?";
+}
+
+} // namespace sim::tagmatch
@@ -0,0 +1,75 @@
+#include "tick_barrier.hpp"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sim
+{
+
+namespace {
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Park/unpark sobre la palabra de época. En Linux va directo al futex
+// (privado al proceso); en otros sistemas usamos atomic::wait de C++20.
+inline void park(std::atomic<std::uint32_t>& word, std::uint32_t expected) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word),
+          FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+  word.wait(expected, std::memory_order_acquire);
+#endif
+}
+
+inline void unpark_all(std::atomic<std::uint32_t>& word) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word),
+          FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+  word.notify_all();
+#endif
+}
+
+} // namespace
+
+SpinParkBarrier::SpinParkBarrier(std::size_t participants, std::uint32_t spin_limit)
+    : remaining_(static_cast<std::uint32_t>(participants)),
+      participants_(static_cast<std::uint32_t>(participants)),
+      spin_limit_(spin_limit) {}
+
+void SpinParkBarrier::arrive_and_wait() {
+  // Leer la época ANTES de llegar: si la leyéramos después, el último
+  // podría abrir en medio y nos quedaríamos esperando la siguiente.
+  const std::uint32_t epoch = epoch_.load(std::memory_order_acquire);
+
+  if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // Último en llegar: rearmar e invertir el sentido
+    remaining_.store(participants_, std::memory_order_relaxed);
+    epoch_.store(epoch + 1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) != 0) unpark_all(epoch_);
+    return;
+  }
+
+  // Fase 1: spin acotado
+  for (std::uint32_t i = 0; i < spin_limit_; ++i) {
+    if (epoch_.load(std::memory_order_acquire) != epoch) return;
+    cpu_relax();
+  }
+
+  // Fase 2: park. El seq_cst en sleepers_/epoch_ (de ambos lados) garantiza
+  // que o el que abre nos ve estacionados, o nosotros vemos la época nueva.
+  sleepers_.fetch_add(1, std::memory_order_seq_cst);
+  while (epoch_.load(std::memory_order_seq_cst) == epoch) park(epoch_, epoch);
+  sleepers_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+} // namespace sim
@@ -0,0 +1,245 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sim {
+
+namespace {
+
+constexpr std::size_t kChunkHdr  = 16;
+constexpr std::size_t kRawRecord = 16;
+
+struct ChunkHdr {
+  std::uint32_t pe, count, bytes, encoding;
+};
+
+ChunkHdr read_hdr(const std::uint8_t* p) {
+  ChunkHdr h;
+  std::memcpy(&h, p, sizeof(h));
+  return h;
+}
+
+[[noreturn]] void truncated() {
+  throw std::runtime_error("Traza corrupta: registro fuera del chunk");
+}
+
+std::uint8_t get_u8(const std::uint8_t*& p, const std::uint8_t* end) {
+  if (p >= end) truncated();
+  return *p++;
+}
+
+std::uint64_t get_varint(const std::uint8_t*& p, const std::uint8_t* end) {
+  std::uint64_t v = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    const std::uint8_t b = get_u8(p, end);
+    v |= std::uint64_t{b & 0x7Fu} << shift;
+    if (!(b & 0x80u)) return v;
+  }
+  truncated();
+}
+
+std::int64_t unzigzag(std::uint64_t v) {
+  return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+} // namespace
+
+void decode_trace_event(const std::uint8_t*& p, TraceChunkState& st, TraceEvent& out) {
+  out.pe = st.pe;
+  switch (st.enc) {
+  case TraceEncoding::Raw: {
+    if (static_cast<std::size_t>(st.end - p) < kRawRecord) truncated();
+    out.bus = false;
+    out.tick = 0;
+    std::memcpy(&out.acc.addr, p, 8);
+    std::memcpy(&out.acc.gap, p + 8, 4);
+    out.acc.type = p[12] ? AccessType::Store : AccessType::Load;
+    out.acc.size = p[13];
+    p += kRawRecord;
+    return;
+  }
+  case TraceEncoding::Delta: {
+    out.bus = false;
+    st.tick += get_varint(p, st.end);
+    out.tick = st.tick;
+    out.acc.gap = static_cast<std::uint32_t>(get_varint(p, st.end));
+    st.addr += static_cast<Addr>(unzigzag(get_varint(p, st.end)));
+    out.acc.addr = st.addr;
+    const std::uint8_t ts = get_u8(p, st.end);
+    out.acc.type = (ts & 1u) ? AccessType::Store : AccessType::Load;
+    out.acc.size = ts >> 1;
+    return;
+  }
+  case TraceEncoding::Bus: {
+    out.bus = true;
+    st.tick += get_varint(p, st.end);
+    out.tick = st.tick;
+    const std::uint8_t f = get_u8(p, st.end);
+    out.cmd       = static_cast<BusCmd>(f & 0x0Fu);
+    out.shared    = (f >> 4) & 1u;
+    out.from_peer = (f >> 5) & 1u;
+    out.pe        = static_cast<PEId>(get_varint(p, st.end));
+    st.addr      += static_cast<Addr>(unzigzag(get_varint(p, st.end)));
+    out.addr      = st.addr;
+    out.size      = static_cast<std::size_t>(get_varint(p, st.end));
+    return;
+  }
+  }
+  throw std::runtime_error("Traza con encoding desconocido");
+}
+
+// ---------- TraceFile ----------
+TraceFile::TraceFile(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("No se puede abrir la traza: " + path);
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(kTraceMagic))) {
+    ::close(fd);
+    throw std::runtime_error("Traza inválida (muy chica): " + path);
+  }
+  size_ = static_cast<std::size_t>(st.st_size);
+  void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) throw std::runtime_error("mmap falló: " + path);
+  data_ = static_cast<const std::uint8_t*>(p);
+  ::madvise(p, size_, MADV_SEQUENTIAL);
+
+  if (std::memcmp(data_, kTraceMagic, sizeof(kTraceMagic)) != 0) {
+    ::munmap(p, size_);
+    throw std::runtime_error("Traza sin magic MPTRACE1: " + path);
+  }
+
+  // Validación de la cadena de chunks (sólo headers; los registros delta se
+  // validan al decodificarlos)
+  for (std::size_t off = sizeof(kTraceMagic); off < size_; ) {
+    if (size_ - off < kChunkHdr) {
+      ::munmap(p, size_);
+      throw std::runtime_error("Traza truncada (header de chunk): " + path);
+    }
+    const ChunkHdr h = read_hdr(data_ + off);
+    const bool is_bus = h.pe == kTraceBusPe;
+    bool ok = h.bytes <= size_ - off - kChunkHdr;
+    switch (static_cast<TraceEncoding>(h.encoding)) {
+    case TraceEncoding::Raw:   ok = ok && !is_bus && h.bytes == std::uint64_t{h.count} * kRawRecord; break;
+    case TraceEncoding::Delta: ok = ok && !is_bus && h.bytes >= h.count; break;
+    case TraceEncoding::Bus:   ok = ok &&  is_bus && h.bytes >= h.count; break;
+    default:                   ok = false;
+    }
+    if (!ok) {
+      ::munmap(p, size_);
+      throw std::runtime_error("Traza con chunk inválido en offset " + std::to_string(off) + ": " + path);
+    }
+    if (is_bus) {
+      bus_records_ += h.count;
+    } else {
+      pes_ = std::max<std::size_t>(pes_, std::size_t{h.pe} + 1);
+      accesses_ += h.count;
+    }
+    off += kChunkHdr + h.bytes;
+  }
+}
+
+TraceFile::~TraceFile() {
+  if (data_) ::munmap(const_cast<std::uint8_t*>(data_), size_);
+}
+
+// ---------- TraceReader ----------
+TraceReader::TraceReader(std::shared_ptr<const TraceFile> file, PEId pe)
+    : file_(std::move(file)), pe_(pe) {}
+
+bool TraceReader::next(Access& out) {
+  if (pos_ == len_ && !refill()) return false;
+  out = buf_[pos_++];
+  return true;
+}
+
+bool TraceReader::next_chunk() {
+  const std::uint8_t* base = file_->data();
+  while (off_ < file_->size()) {
+    const ChunkHdr h = read_hdr(base + off_);
+    const std::size_t payload = off_ + kChunkHdr;
+    off_ = payload + h.bytes;
+    if (h.pe == pe_ && h.count) {
+      rec_  = base + payload;
+      left_ = h.count;
+      st_   = TraceChunkState{static_cast<TraceEncoding>(h.encoding), pe_, base + off_};
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TraceReader::refill() {
+  pos_ = len_ = 0;
+  TraceEvent ev;
+  while (len_ < kBatch) {
+    if (!left_ && !next_chunk()) break;
+    const std::size_t n = std::min<std::size_t>(kBatch - len_, left_);
+    for (std::size_t i = 0; i < n; ++i) {
+      decode_trace_event(rec_, st_, ev);
+      buf_[len_++] = ev.acc;
+    }
+    left_ -= static_cast<std::uint32_t>(n);
+  }
+
+  // Read-ahead: el próximo bloque de este chunk ya se va pidiendo al kernel
+  if (left_) {
+    const auto page = reinterpret_cast<std::uintptr_t>(rec_) & ~std::uintptr_t{4095};
+    ::madvise(reinterpret_cast<void*>(page), kBatch * kRawRecord + 4096, MADV_WILLNEED);
+  }
+  return len_ > 0;
+}
+
+// ---------- TraceWriter ----------
+TraceWriter::TraceWriter(const std::string& path, std::size_t chunk_records)
+    : path_(path), out_(path, std::ios::binary | std::ios::trunc),
+      chunk_records_(std::max<std::size_t>(1, chunk_records)) {
+  if (!out_) throw std::runtime_error("No se puede escribir la traza: " + path);
+  out_.write(kTraceMagic, sizeof(kTraceMagic));
+}
+
+TraceWriter::~TraceWriter() {
+  try { close(); } catch (...) {}
+}
+
+void TraceWriter::append(PEId pe, const Access& a) {
+  if (pe >= bufs_.size()) bufs_.resize(pe + 1);
+  auto& b = bufs_[pe];
+  b.push_back(a);
+  if (b.size() >= chunk_records_) flush(pe);
+}
+
+void TraceWriter::flush(PEId pe) {
+  auto& b = bufs_[pe];
+  if (b.empty()) return;
+  std::vector<std::uint8_t> payload(b.size() * kRawRecord, 0);
+  std::uint8_t* r = payload.data();
+  for (const auto& a : b) {
+    std::memcpy(r, &a.addr, 8);
+    std::memcpy(r + 8, &a.gap, 4);
+    r[12] = a.type == AccessType::Store ? 1 : 0;
+    r[13] = static_cast<std::uint8_t>(std::min<std::size_t>(a.size, 255));
+    r += kRawRecord;
+  }
+  const ChunkHdr h{pe, static_cast<std::uint32_t>(b.size()),
+                   static_cast<std::uint32_t>(payload.size()),
+                   static_cast<std::uint32_t>(TraceEncoding::Raw)};
+  out_.write(reinterpret_cast<const char*>(&h), sizeof(h));
+  out_.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+  b.clear();
+}
+
+void TraceWriter::close() {
+  if (!out_.is_open()) return;
+  for (PEId pe = 0; pe < bufs_.size(); ++pe) flush(pe);
+  out_.close();
+  if (!out_) throw std::runtime_error("Error escribiendo la traza: " + path_);
+}
+
+} // namespace sim
@@ -0,0 +1,102 @@
+// Sin contracción a FMA: en hosts con FMA nativo el compilador podría fusionar
+// a*b + c en el camino escalar y dejaría de coincidir con las variantes SIMD
+#pragma GCC optimize("fp-contract=off")
+
+#include "vec_ops.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MPMESI_X86 1
+#else
+#define MPMESI_X86 0
+#endif
+
+namespace sim::vecops
+{
+
+namespace {
+
+void fma_scalar(double* acc, const double* a, const double* b, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    const double p = a[i] * b[i];
+    acc[i] = acc[i] + p;
+  }
+}
+
+// Plegado escalar desde la mitad 'h' (los pasos anteriores ya los hizo el SIMD)
+double fold_scalar(double* t, std::size_t h) {
+  for (; h >= 1; h /= 2)
+    for (std::size_t i = 0; i < h; ++i) t[i] += t[i + h];
+  return t[0];
+}
+
+#if MPMESI_X86
+// SSE2 es base en x86-64: no necesita 'target' ni chequeo de CPU
+void fma_sse2(double* acc, const double* a, const double* b, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m128d p = _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+    _mm_storeu_pd(acc + i, _mm_add_pd(_mm_loadu_pd(acc + i), p));
+  }
+  fma_scalar(acc + i, a + i, b + i, n - i);
+}
+
+double hsum_sse2(const double* v, std::size_t n) {
+  if (n <= 1) return n ? v[0] : 0.0;
+  double t[kMaxLanes];
+  std::memcpy(t, v, n * sizeof(double));
+  std::size_t h = n / 2;
+  for (; h >= 2; h /= 2)
+    for (std::size_t i = 0; i < h; i += 2)
+      _mm_storeu_pd(t + i, _mm_add_pd(_mm_loadu_pd(t + i), _mm_loadu_pd(t + i + h)));
+  return fold_scalar(t, h);
+}
+
+__attribute__((target("avx")))
+void fma_avx(double* acc, const double* a, const double* b, std::size_t n) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d p = _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+    _mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), p));
+  }
+  fma_sse2(acc + i, a + i, b + i, n - i);
+}
+
+__attribute__((target("avx")))
+double hsum_avx(const double* v, std::size_t n) {
+  if (n <= 1) return n ? v[0] : 0.0;
+  double t[kMaxLanes];
+  std::memcpy(t, v, n * sizeof(double));
+  std::size_t h = n / 2;
+  for (; h >= 4; h /= 2)
+    for (std::size_t i = 0; i < h; i += 4)
+      _mm256_storeu_pd(t + i, _mm256_add_pd(_mm256_loadu_pd(t + i), _mm256_loadu_pd(t + i + h)));
+  for (; h >= 2; h /= 2)
+    _mm_storeu_pd(t, _mm_add_pd(_mm_loadu_pd(t), _mm_loadu_pd(t + h)));
+  return fold_scalar(t, h);
+}
+
+Kernels resolve() {
+  if (__builtin_cpu_supports("avx")) return {fma_avx, hsum_avx, "avx"};
+  return {fma_sse2, hsum_sse2, "sse2"};
+}
+#else
+double hsum_scalar(const double* v, std::size_t n) {
+  if (n <= 1) return n ? v[0] : 0.0;
+  double t[kMaxLanes];
+  std::memcpy(t, v, n * sizeof(double));
+  return fold_scalar(t, n / 2);
+}
+
+Kernels resolve() { return {fma_scalar, hsum_scalar, "scalar"}; }
+#endif
+
+} // namespace
+
+const Kernels& kernels() {
+  static const Kernels k = resolve();
+  return k;
+}
+
+} // namespace sim::vecops
@@ -0,0 +1,96 @@
+#include "work_pool.hpp"
+#include <algorithm>
+
+namespace sim
+{
+
+WorkStealingPool::WorkStealingPool(std::size_t workers, std::uint32_t spin_limit)
+    : start_(std::max<std::size_t>(1, workers), spin_limit),
+      finish_(std::max<std::size_t>(1, workers), spin_limit)
+{
+  workers = std::max<std::size_t>(1, workers);
+  queues_.reserve(workers);
+  for (std::size_t i = 0; i < workers; ++i) queues_.push_back(std::make_unique<Queue>());
+
+  // El worker 0 es el hilo que llama a run()
+  for (std::size_t i = 1; i < workers; ++i)
+    threads_.emplace_back(&WorkStealingPool::worker_loop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  halt_.store(true, std::memory_order_release);
+  start_.arrive_and_wait();
+  for (auto& t : threads_) if (t.joinable()) t.join();
+}
+
+void WorkStealingPool::run(std::size_t n, const std::function<void(std::size_t)>& fn) {
+  const std::size_t W = queues_.size();
+
+  // Rangos chicos para que haya qué robar, pero no tanto como 1 PE por tarea
+  const std::size_t chunk = std::max<std::size_t>(1, n / (W * 4));
+
+  // Reparto contiguo: el worker w se queda con el bloque w-ésimo de [0, n)
+  const std::size_t per_worker = (n + W - 1) / W;
+  for (std::size_t w = 0; w < W; ++w) {
+    auto& q = *queues_[w];
+    std::scoped_lock lk(q.m);
+    q.items.clear();
+    q.head = 0;
+    const std::size_t b = std::min(n, w * per_worker);
+    const std::size_t e = std::min(n, b + per_worker);
+    for (std::size_t i = b; i < e; i += chunk) q.items.push_back({i, std::min(e, i + chunk)});
+  }
+
+  fn_ = &fn;
+  start_.arrive_and_wait();   // abre el lote (publica fn_ y las colas)
+  drain(0);
+  finish_.arrive_and_wait();  // todos terminaron sus rangos
+  fn_ = nullptr;
+}
+
+void WorkStealingPool::worker_loop(std::size_t self) {
+  while (true) {
+    start_.arrive_and_wait();
+    if (halt_.load(std::memory_order_acquire)) break;
+    drain(self);
+    finish_.arrive_and_wait();
+  }
+}
+
+void WorkStealingPool::drain(std::size_t self) {
+  const auto& fn = *fn_;
+  Range r{};
+
+  // 1) Cola propia
+  while (pop_front(self, r))
+    for (std::size_t i = r.begin; i < r.end; ++i) fn(i);
+
+  // 2) Robo: recorremos las demás colas empezando por la vecina
+  const std::size_t W = queues_.size();
+  for (std::size_t k = 1; k < W; ++k) {
+    const std::size_t victim = (self + k) % W;
+    while (steal_back(victim, r)) {
+      steals_.fetch_add(1, std::memory_order_relaxed);
+      for (std::size_t i = r.begin; i < r.end; ++i) fn(i);
+    }
+  }
+}
+
+bool WorkStealingPool::pop_front(std::size_t q, Range& out) {
+  auto& Q = *queues_[q];
+  std::scoped_lock lk(Q.m);
+  if (Q.head >= Q.items.size()) return false;
+  out = Q.items[Q.head++];
+  return true;
+}
+
+bool WorkStealingPool::steal_back(std::size_t q, Range& out) {
+  auto& Q = *queues_[q];
+  std::scoped_lock lk(Q.m);
+  if (Q.head >= Q.items.size()) return false;
+  out = Q.items.back();
+  Q.items.pop_back();
+  return true;
+}
+
+} // namespace sim
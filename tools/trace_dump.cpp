@@ -0,0 +1,80 @@
+// Decodificador de trazas / grabaciones (formato de include/trace.hpp).
+//
+//   make trace-dump ARGS="run.trc"          (objetos en build/tools)
+//   build/tools/trace_dump [--summary] [--pe N] [--bus] FILE
+//
+// Imprime un registro por línea, en el orden del archivo (por chunks):
+//   t=<tick> PE<n> LOAD|STORE 0x<addr> size=<s> gap=<g>
+//   t=<tick> BUS  PE<n> BusRd|BusRdX|... 0x<addr> size=<s> [shared] [peer]
+// --summary sólo cuenta; --pe N filtra los accesos de un PE; --bus sólo el bus.
+
+#include "trace.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+using namespace sim;
+
+int main(int argc, char** argv) {
+  bool summary = false, only_bus = false;
+  long only_pe = -1;
+  std::string path;
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if      (a == "--summary")            summary  = true;
+    else if (a == "--bus")                only_bus = true;
+    else if (a == "--pe" && i + 1 < argc) only_pe  = std::strtol(argv[++i], nullptr, 10);
+    else                                  path     = a;
+  }
+  if (path.empty()) {
+    std::fprintf(stderr, "Uso: trace_dump [--summary] [--pe N] [--bus] FILE\n");
+    return 1;
+  }
+
+  try {
+    const TraceFile f(path);
+    std::vector<std::uint64_t> loads(f.pes()), stores(f.pes());
+    std::uint64_t cmds[5] = {0};
+
+    f.for_each_event([&](const TraceEvent& e) {
+      if (e.bus) {
+        ++cmds[static_cast<std::size_t>(e.cmd) % 5];
+        if (summary || only_pe >= 0) return;
+        std::printf("t=%llu BUS  PE%u %s 0x%llx size=%zu%s%s\n",
+                    static_cast<unsigned long long>(e.tick), e.pe, cmd_str(e.cmd),
+                    static_cast<unsigned long long>(e.addr), e.size,
+                    e.shared ? " shared" : "", e.from_peer ? " peer" : "");
+        return;
+      }
+      (e.acc.type == AccessType::Store ? stores : loads)[e.pe]++;
+      if (summary || only_bus || (only_pe >= 0 && e.pe != static_cast<PEId>(only_pe))) return;
+      std::printf("t=%llu PE%u %s 0x%llx size=%zu gap=%u\n",
+                  static_cast<unsigned long long>(e.tick), e.pe,
+                  e.acc.type == AccessType::Store ? "STORE" : "LOAD ",
+                  static_cast<unsigned long long>(e.acc.addr), e.acc.size, e.acc.gap);
+    });
+
+    const std::uint64_t n = f.accesses() + f.bus_records();
+    std::fprintf(summary ? stdout : stderr,
+                 "%s: %zu B | %llu accesos (%zu PEs) | %llu requests | %.2f B/registro\n",
+                 path.c_str(), f.size(), static_cast<unsigned long long>(f.accesses()), f.pes(),
+                 static_cast<unsigned long long>(f.bus_records()),
+                 n ? static_cast<double>(f.size()) / static_cast<double>(n) : 0.0);
+    if (summary) {
+      for (std::size_t pe = 0; pe < f.pes(); ++pe)
+        std::printf("  PE%zu: loads=%llu stores=%llu\n", pe,
+                    static_cast<unsigned long long>(loads[pe]), static_cast<unsigned long long>(stores[pe]));
+      for (std::size_t c = 1; c < 5; ++c)
+        if (cmds[c])
+          std::printf("  %s=%llu\n", cmd_str(static_cast<BusCmd>(c)), static_cast<unsigned long long>(cmds[c]));
+    }
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "[trace_dump] %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+// Generador de trazas sintéticas para --trace (formato crudo de include/trace.hpp).
+//
+//   make trace-gen ARGS="--pattern shared -o shared.trc"   (objetos en build/tools)
+//   build/tools/trace_gen [--pattern P] [--pes N] [--accesses N] [--lines N]
+//                         [--line-bytes N] [--write-pct N] [--gap N] [--seed N] -o FILE
+//
+// Patrones (--lines líneas de --line-bytes bytes por región):
+//   private   cada PE recorre su propia región (sin compartir)
+//   shared    todos leen la misma región al azar; --write-pct % son stores
+//   migratory los PEs se pasan las líneas: cada uno lee y escribe la línea
+//             que otro PE escribió en la ronda anterior
+//   false     cada PE escribe su propia palabra dentro de las mismas líneas
+//
+// Sirve para comparar protocolos y modos de coherencia con patrones de
+// compartición controlados, sin escribir asm.
+
+#include "trace.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <random>
+#include <string>
+
+using namespace sim;
+
+int main(int argc, char** argv) {
+  std::string pattern = "shared", path;
+  std::size_t pes = 4, accesses = 100000, lines = 256, line_bytes = 64;
+  unsigned    write_pct = 10, gap = 0;
+  std::uint64_t seed = 1;
+
+  auto num = [&](int& i) { return std::strtoull(argv[++i], nullptr, 10); };
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool has = i + 1 < argc;
+    if      (a == "--pattern"    && has) pattern    = argv[++i];
+    else if (a == "--pes"        && has) pes        = num(i);
+    else if (a == "--accesses"   && has) accesses   = num(i);
+    else if (a == "--lines"      && has) lines      = num(i);
+    else if (a == "--line-bytes" && has) line_bytes = num(i);
+    else if (a == "--write-pct"  && has) write_pct  = static_cast<unsigned>(num(i));
+    else if (a == "--gap"        && has) gap        = static_cast<unsigned>(num(i));
+    else if (a == "--seed"       && has) seed       = num(i);
+    else if (a == "-o"           && has) path       = argv[++i];
+    else { path.clear(); break; }
+  }
+  const bool known = pattern == "private" || pattern == "shared" ||
+                     pattern == "migratory" || pattern == "false";
+  if (path.empty() || !known || pes == 0 || lines == 0 || line_bytes < sizeof(Word)) {
+    std::fprintf(stderr,
+                 "Uso: trace_gen [--pattern private|shared|migratory|false] [--pes N]\n"
+                 "                [--accesses N] [--lines N] [--line-bytes N] [--write-pct N]\n"
+                 "                [--gap N] [--seed N] -o FILE\n");
+    return 1;
+  }
+
+  try {
+    TraceWriter w(path);
+    std::mt19937_64 rng(seed);
+    const std::size_t words_per_line = line_bytes / sizeof(Word);
+    const Addr        region         = static_cast<Addr>(lines * line_bytes);
+    auto is_store = [&] { return rng() % 100 < write_pct; };
+
+    // Intercalado por PE: cada PE sólo ve sus accesos en orden, así que el
+    // orden entre PEs lo deciden los gaps y el bus al reproducir
+    for (std::size_t i = 0; i < accesses; ++i) {
+      for (std::size_t pe = 0; pe < pes; ++pe) {
+        Access a{AccessType::Load, 0, sizeof(Word), gap};
+        if (pattern == "private") {
+          a.addr = region * pe + (i % (lines * words_per_line)) * sizeof(Word);
+          a.type = is_store() ? AccessType::Store : AccessType::Load;
+        } else if (pattern == "shared") {
+          a.addr = (rng() % (lines * words_per_line)) * sizeof(Word);
+          a.type = is_store() ? AccessType::Store : AccessType::Load;
+        } else if (pattern == "migratory") {
+          // Ronda r = i/2: el PE toma la línea r + pe (load y store); en la ronda r+1 la toma pe-1
+          const std::size_t line = (i / 2 + pe) % lines;
+          a.addr = static_cast<Addr>(line * line_bytes);
+          a.type = i % 2 ? AccessType::Store : AccessType::Load;
+        } else {
+          // false sharing: palabra 'pe' de la línea i (con más PEs que palabras, se repiten)
+          a.addr = static_cast<Addr>((i % lines) * line_bytes + (pe % words_per_line) * sizeof(Word));
+          a.type = AccessType::Store;
+        }
+        w.append(static_cast<PEId>(pe), a);
+      }
+    }
+    w.close();
+    std::fprintf(stderr, "[trace_gen] %s: %s, %zu PEs x %zu accesos (región %llu B)\n",
+                 path.c_str(), pattern.c_str(), pes, accesses, static_cast<unsigned long long>(region));
+  } catch (const std::exception& e) {
+    std::fprintf(stderr, "[trace_gen] %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}